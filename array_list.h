@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <type_traits>
 #include <stdexcept>
 
+#include <simd.h>
 #include <utils.h>
 
 namespace structures {
@@ -20,7 +23,7 @@ public:
 	Arraylist(Arraylist<T>&& other)
 		: contents{std::move(other.contents)}
 		, size_{std::move(other.size_)}
-		, ma	x_size_{std::move(other.max_size_)} {
+		, max_size_{std::move(other.max_size_)} {
 		other.size_ = 0;
 		other.max_size_ = 0;
 	}
@@ -70,12 +73,59 @@ public:
 		}
 	}
 
-	/* Insert an element 'data' sorted to the list */
-	void insert_sorted(const T& data) {
-		std::size_t i = 0;
-		while (i < size_ && data >= contents[i])
-			i++;
-		insert(data, i);
+	/* Insert an element 'data' sorted to the list, after any equal elements */
+	void insert_sorted(const T& data) { insert(data, upper_bound(data)); }
+
+	/* Insert the elements of [first, last) into the sorted list: the batch is
+	   sorted and then merged in from the back in a single pass. The run of
+	   elements that goes after each batch element is found by galloping, so a
+	   small batch costs O(m log(n / m)) comparisons instead of O(n) */
+	template <typename It>
+	void insert_sorted_range(It first, It last) {
+		Arraylist<T> batch;
+		for (; first != last; ++first)
+			batch.push_at_back(*first);
+		if (batch.empty())
+			return;
+		std::sort(&batch[0], &batch[0] + batch.size());
+
+		std::size_t total = size_ + batch.size();
+		if (total >= max_size_) {
+			std::size_t new_size = max_size_ > 0 ? max_size_ : starting_size;
+			while (new_size <= total)
+				new_size *= 2;
+			contents = copy_array(contents, size_, new_size);
+			max_size_ = new_size;
+		}
+
+		std::size_t i = size_, j = batch.size(), k = total;
+		while (j > 0) {
+			std::size_t from = gallop(batch[j - 1], i);
+			std::move_backward(&contents[from], &contents[i], &contents[k]);
+			k -= i - from;
+			i = from;
+			contents[--k] = batch[--j];
+		}
+		size_ = total;
+	}
+
+	/* In a sorted list, return the position of the first element not less
+	   than 'data' */
+	std::size_t lower_bound(const T& data) const {
+		return search(data, [](const T& x, const T& d) { return x < d; });
+	}
+
+	/* In a sorted list, return the position of the first element greater than
+	   'data' */
+	std::size_t upper_bound(const T& data) const {
+		return search(data, [](const T& x, const T& d) { return !(d < x); });
+	}
+
+	/* Return the position of 'data' in a sorted list, or size() if it is not
+	   in the list. O(log n) instead of find()'s O(n) */
+	std::size_t sorted_find(const T& data) const {
+		std::size_t i = lower_bound(data);
+		return i < size_ && !(data < contents[i]) ? i : size_;
 	}
 
 	/* Remove an element from a given position ('index') */
@@ -104,8 +154,18 @@ public:
 	/* Remove first element of a list */
 	T pop_at_front() { return erase(0); }
 
-	/* Remove an element 'data' from the list */
-	void remove(const T& data) { erase(find(data)); }
+	/* Remove an element at a given position ('index') if there is one.
+	   Returns false instead of throwing when 'index' is out of bounds */
+	bool try_erase(std::size_t index) {
+		if (index >= size_)
+			return false;
+		erase(index);
+		return true;
+	}
+
+	/* Remove an element 'data' from the list, returns false if it is not in
+	   the list */
+	bool remove(const T& data) { return try_erase(find(data)); }
 
 	/* Return True if list is empty */
 	bool empty() const { return size_ == 0; }
@@ -113,13 +173,25 @@ public:
 	/* return True if the list contains 'data' */
 	bool contains(const T& data) const { return find(data) != size_; }
 
-	/* Return the position of 'data' in the list */
+	/* Return the position of 'data' in the list. Lists of 32/64 bit integers,
+	   floats and doubles are scanned with SIMD instructions (see simd.h) */
 	std::size_t find(const T& data) const {
-		for (std::size_t i = 0; i < size_; ++i) {
-			if (contents[i] == data)
-				return i;
-		}
-		return size_;
+		return simd::find(contents.get(), size_, data);
+	}
+
+	/* Return how many elements are equal to 'data' */
+	std::size_t count(const T& data) const {
+		return simd::count(contents.get(), size_, data);
+	}
+
+	/* Return the position of the first smallest element, size() if empty */
+	std::size_t find_min() const {
+		return simd::min_element(contents.get(), size_);
+	}
+
+	/* Return the position of the first largest element, size() if empty */
+	std::size_t find_max() const {
+		return simd::max_element(contents.get(), size_);
 	}
 
 	/* Return the list's size */
@@ -157,6 +229,60 @@ public:
 	const T& back() const { return contents[size_ - 1]; }
 
 private:
+	/* Binary search for the first element for which 'before' is false.
+	   Arithmetic types use a branchless loop (the comparison becomes a
+	   conditional move), other types the usual one */
+	template <typename Before>
+	std::size_t search(const T& data, Before before) const {
+		return search(data, before, std::is_arithmetic<T>{});
+	}
+
+	template <typename Before>
+	std::size_t search(const T& data, Before before, std::true_type) const {
+		if (size_ == 0)
+			return 0;
+		const T* base = contents.get();
+		std::size_t n = size_;
+		while (n > 1) {
+			std::size_t half = n / 2;
+			base = before(base[half], data) ? base + half : base;
+			n -= half;
+		}
+		return (base - contents.get()) + before(*base, data);
+	}
+
+	template <typename Before>
+	std::size_t search(const T& data, Before before, std::false_type) const {
+		std::size_t lo = 0, hi = size_;
+		while (lo < hi) {
+			std::size_t mid = lo + (hi - lo) / 2;
+			if (before(contents[mid], data))
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	/* Position of the first element of [0, end) greater than 'data',
+	   searched from the back: steps of 1, 2, 4... bound the run, then a
+	   binary search inside the last step */
+	std::size_t gallop(const T& data, std::size_t end) const {
+		std::size_t step = 1;
+		while (step <= end && data < contents[end - step])
+			step *= 2;
+		std::size_t lo = step <= end ? end - step + 1 : 0;
+		std::size_t hi = end - step / 2;
+		while (lo < hi) {
+			std::size_t mid = lo + (hi - lo) / 2;
+			if (data < contents[mid])
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		return lo;
+	}
+
 	void expand(float ratio) {
 		contents = copy_array(contents, size_, max_size_ * ratio);
 		max_size_ *= ratio;
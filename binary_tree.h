@@ -85,7 +85,7 @@ struct Node {
 	}
 
 	void pre_order(Arraylist<T>& v) const {
-		v.push_back(data);
+		v.push_at_back(data);
 		if (left)
 			left->pre_order(v);
 		if (right)
@@ -95,7 +95,7 @@ struct Node {
 	void in_order(Arraylist<T>& v) const {
 		if (left)
 			left->in_order(v);
-		v.push_back(data);
+		v.push_at_back(data);
 		if (right)
 			right->in_order(v);
 	}
@@ -105,7 +105,7 @@ struct Node {
 			left->post_order(v);
 		if (right)
 			right->post_order(v);
-		v.push_back(data);
+		v.push_at_back(data);
 	}
 
 	/* return the smallest value of the right sub-tree */
@@ -0,0 +1,228 @@
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <hash_functions.h>
+
+namespace structures {
+
+/* Blocked Bloom filter: approximate set membership with no false negatives
+ * and a configurable false positive rate.
+ * Every key maps to one 64 byte block (a cache line) and sets k bits inside
+ * it, so a lookup touches a single cache line. Keys cannot be removed; the
+ * filter is rebuilt instead (see Hashtablewrapper).
+ * The filter also counts its queries, so the rate of false positives actually
+ * seen can be reported once the owner tells it which positives were false.
+ * param T: data type of the keys
+ * param Hash: hash function of the keys. Its result is mixed again, so a
+ * plain std::hash is fine */
+template <typename T, typename Hash = std::hash<T>>
+class Bloomfilter {
+public:
+	const static bool enabled{true};
+
+	/* Sized for 'expected' keys at a false positive rate of 'rate' */
+	explicit Bloomfilter(std::size_t expected = 0, double rate = 0.01)
+		: rate_{rate} {
+		reset(expected);
+	}
+
+	Bloomfilter(const Bloomfilter<T, Hash>& other)
+		: rate_{other.rate_}
+		, hashes{other.hashes}
+		, queries_{other.queries()}
+		, rejected_{other.rejected()}
+		, false_positives_{other.false_positives()}
+		, hashf{other.hashf} {
+		allocate(other.blocks_size);
+		if (other.blocks)
+			std::memcpy(blocks, other.blocks, blocks_size * block_bytes);
+	}
+
+	Bloomfilter(Bloomfilter<T, Hash>&& other)
+		: rate_{other.rate_}
+		, hashes{other.hashes}
+		, storage{std::move(other.storage)}
+		, blocks{other.blocks}
+		, blocks_size{other.blocks_size}
+		, queries_{other.queries()}
+		, rejected_{other.rejected()}
+		, false_positives_{other.false_positives()}
+		, hashf{std::move(other.hashf)} {
+		other.blocks = nullptr;
+		other.blocks_size = 0;
+	}
+
+	Bloomfilter<T, Hash>& operator=(const Bloomfilter<T, Hash>& other) {
+		Bloomfilter<T, Hash> copy{other};
+		*this = std::move(copy);
+		return *this;
+	}
+
+	Bloomfilter<T, Hash>& operator=(Bloomfilter<T, Hash>&& other) {
+		if (this == &other)
+			return *this;
+		rate_ = other.rate_;
+		hashes = other.hashes;
+		storage = std::move(other.storage);
+		blocks = other.blocks;
+		blocks_size = other.blocks_size;
+		queries_.store(other.queries(), std::memory_order_relaxed);
+		rejected_.store(other.rejected(), std::memory_order_relaxed);
+		false_positives_.store(other.false_positives(), std::memory_order_relaxed);
+		hashf = std::move(other.hashf);
+		other.blocks = nullptr;
+		other.blocks_size = 0;
+		return *this;
+	}
+
+	/* Empties the filter and sizes it for 'expected' keys, keeping the rate
+	   and the query counters */
+	void reset(std::size_t expected) {
+		double bits_per_key = -std::log(rate_) / (std::log(2.0) * std::log(2.0));
+		// Blocking skews the load of the blocks: a few extra bits per key
+		// bring the rate back to the one asked for
+		bits_per_key *= 1.2;
+		hashes = static_cast<unsigned>(bits_per_key * std::log(2.0) / 1.2 + 0.5);
+		if (hashes < 1)
+			hashes = 1;
+		if (hashes > 16)
+			hashes = 16;
+		auto bits = static_cast<std::size_t>(bits_per_key * expected);
+		allocate(bits / block_bits + 1);
+	}
+
+	/* Sets the false positive rate used from the next reset() on */
+	void set_rate(double rate) { rate_ = rate; }
+
+	/* Empties the filter */
+	void clear() {
+		if (blocks)
+			std::memset(blocks, 0, blocks_size * block_bytes);
+	}
+
+	void insert(const T& x) { insert_hash(hashf(x)); }
+
+	/* Returns false if 'x' was never inserted, true if it probably was */
+	bool contains(const T& x) const { return contains_hash(hashf(x)); }
+
+	/* The same, given the (unmixed) hash of the key */
+	void insert_hash(std::size_t h) {
+		std::uint64_t* block;
+		std::uint32_t a, b;
+		locate(h, block, a, b);
+		for (unsigned i = 0; i < hashes; ++i, a += b)
+			block[(a >> 6) & 7] |= std::uint64_t{1} << (a & 63);
+	}
+
+	bool contains_hash(std::size_t h) const {
+		std::uint64_t* block;
+		std::uint32_t a, b;
+		locate(h, block, a, b);
+		queries_.fetch_add(1, std::memory_order_relaxed);
+		for (unsigned i = 0; i < hashes; ++i, a += b) {
+			if (!(block[(a >> 6) & 7] & (std::uint64_t{1} << (a & 63)))) {
+				rejected_.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/* Tells the filter that the last positive answer was wrong */
+	void record_false_positive() const {
+		false_positives_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/* Number of contains() calls, and how many of them returned false */
+	std::size_t queries() const { return queries_.load(std::memory_order_relaxed); }
+	std::size_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+	std::size_t false_positives() const {
+		return false_positives_.load(std::memory_order_relaxed);
+	}
+
+	/* Share of the absent keys queried that were let through, as recorded
+	   by record_false_positive() */
+	double measured_rate() const {
+		std::size_t fp = false_positives();
+		std::size_t absent = rejected() + fp;
+		return absent == 0 ? 0.0 : static_cast<double>(fp) / absent;
+	}
+
+	/* Expected rate from the share of bits set: fill ^ hashes */
+	double estimated_rate() const {
+		std::size_t ones = 0;
+		for (std::size_t i = 0; i < blocks_size * block_words; ++i)
+			ones += __builtin_popcountll(blocks[i]);
+		double fill = static_cast<double>(ones) / (blocks_size * block_bits);
+		return std::pow(fill, hashes);
+	}
+
+	void reset_counters() {
+		queries_.store(0, std::memory_order_relaxed);
+		rejected_.store(0, std::memory_order_relaxed);
+		false_positives_.store(0, std::memory_order_relaxed);
+	}
+
+	/* Memory used by the bit array, in bytes */
+	std::size_t memory() const { return blocks_size * block_bytes; }
+
+	double rate() const { return rate_; }
+
+private:
+	const static std::size_t block_bytes{64};
+	const static std::size_t block_words{block_bytes / 8};
+	const static std::size_t block_bits{block_bytes * 8};
+
+	/* Allocates 'n' zeroed blocks, aligned to cache lines */
+	void allocate(std::size_t n) {
+		storage.reset(new std::uint64_t[n * block_words + block_words - 1]());
+		auto p = reinterpret_cast<std::uintptr_t>(storage.get());
+		blocks = reinterpret_cast<std::uint64_t*>((p + block_bytes - 1) &
+												  ~std::uintptr_t{block_bytes - 1});
+		blocks_size = n;
+	}
+
+	/* Block of 'h' and the two 32 bit hashes that pick its bits */
+	void locate(std::size_t h, std::uint64_t*& block, std::uint32_t& a,
+				std::uint32_t& b) const {
+		std::uint64_t g = hashing::mix(h);
+		std::size_t i = static_cast<std::size_t>(((g >> 32) * blocks_size) >> 32);
+		block = blocks + i * block_words;
+		std::uint64_t bits = hashing::mum(g, 0x9e3779b97f4a7c15ULL);
+		a = static_cast<std::uint32_t>(bits);
+		b = static_cast<std::uint32_t>(bits >> 32) | 1;
+	}
+
+	double rate_;
+	unsigned hashes{1};
+	std::unique_ptr<std::uint64_t[]> storage;
+	std::uint64_t* blocks{nullptr};
+	std::size_t blocks_size{0};
+
+	/* Updated by const lookups, so concurrent readers only share relaxed
+	   atomic increments */
+	mutable std::atomic<std::size_t> queries_{0};
+	mutable std::atomic<std::size_t> rejected_{0};
+	mutable std::atomic<std::size_t> false_positives_{0};
+
+	Hash hashf{};
+};
+
+template <typename T, typename Hash>
+const bool Bloomfilter<T, Hash>::enabled;
+
+/* Filter that lets everything through: the default for Hashtablewrapper */
+struct Nofilter {
+	const static bool enabled{false};
+
+	explicit Nofilter(std::size_t = 0) {}
+	void reset(std::size_t) {}
+	void insert_hash(std::size_t) {}
+	bool contains_hash(std::size_t) const { return true; }
+	void record_false_positive() const {}
+};
+
+}
\ No newline at end of file
@@ -1,15 +1,42 @@
 #include <stdexcept>
+#include <utility>
 
 namespace structures {
 
-/* Double linked circular list */
+/* Double linked circular list.
+   Inserting functions return a Handle to the new element. A handle stays
+   valid until its element is erased, whatever else happens to the list, and
+   erase, insert_before/after and move_to_front/back through a handle are O(1).
+   Index based access walks from whichever end of the list is closer */
 template <typename T>
 class Circularlist {
+	struct Node;
+
 public:
+	/* Stable reference to one element of a list */
+	class Handle {
+	public:
+		Handle() = default;
+
+		T& operator*() const { return node->x; }
+		T* operator->() const { return &node->x; }
+
+		explicit operator bool() const { return node != nullptr; }
+		bool operator==(const Handle& other) const { return node == other.node; }
+		bool operator!=(const Handle& other) const { return node != other.node; }
+
+	private:
+		friend class Circularlist<T>;
+		explicit Handle(Node* node_) : node{node_} {}
+
+		Node* node{nullptr};
+	};
+
 	Circularlist() = default;
 
 	Circularlist(const Circularlist<T>& other)
-		: head{copy_list(other.head)}, size_{other.size_} {}
+		: head{other.empty() ? nullptr : copy_list(other.head)}
+		, size_{other.size_} {}
 
 	Circularlist(Circularlist<T>&& other)
 		: head{other.head}, size_{other.size_} {
@@ -36,109 +63,148 @@ public:
 	/* Clears all elements of the list */
 	void clear() {
 		while (!empty()) {
-			pop_back();
+			pop_at_back();
 		}
 	}
 
 	/* Insert the element 'x' at the end of the list  */
-	void push_at_back(const T& x) {
+	Handle push_at_back(const T& x) {
 		if (empty()) {
 			head = new Node(x);
 			head->next = head;
 			head->prev = head;
-		} else {
-			auto newNode = new Node(x, head->prev, head);
-			newNode->prev->next = newNode;
-			head->prev = newNode;
+			++size_;
+			return Handle{head};
 		}
-		++size_;
+		return Handle{link_before(head, x)};
 	}
 
 	/* Insert the element 'x' at the beginning of the list*/
-	void push_at_front(const T& x) {
-		push_back(x);
-		head = head->prev;
+	Handle push_at_front(const T& x) {
+		Handle h = push_at_back(x);
+		head = h.node;
+		return h;
 	}
 
 	/* Insert the element 'x' at the given position 'index' of the list */
-	void insert(const T& x, std::size_t index) {
-		if (index == 0) {
-			push_back(x);
-			head = head->prev;
-		} else if (index > size_) {
+	Handle insert(const T& x, std::size_t index) {
+		if (index > size_)
 			throw std::out_of_range("Invalid index (insert())");
-		} else {
-			auto it = head;
-			for (std::size_t i = 0; i < index - 1; ++i) {
-				it = it->next;
-			}
-			it->next = new Node(x, it, it->next);
-			it->next->next->prev = it->next;
-			++size_;
-		}
+		if (index == 0)
+			return push_at_front(x);
+		if (index == size_)
+			return push_at_back(x);
+		return Handle{link_before(node_at(index), x)};
+	}
+
+	/* Insert the element 'x' right before the element of 'position' */
+	Handle insert_before(Handle position, const T& x) {
+		if (position.node == head)
+			return push_at_front(x);
+		return Handle{link_before(position.node, x)};
+	}
+
+	/* Insert the element 'x' right after the element of 'position' */
+	Handle insert_after(Handle position, const T& x) {
+		return Handle{link_before(position.node->next, x)};
 	}
 
 	/* Insert the element 'x' sorted in the list  */
-	void insert_sorted(const T& x) {
+	Handle insert_sorted(const T& x) {
 		if (empty() || x <= head->x)
-			return push_front(x);
+			return push_at_front(x);
+		if (x >= head->prev->x)
+			return push_at_back(x);  // no scan when appending in order
 		auto it = head;
 		while (it->next != head && x > it->next->x) {
 			it = it->next;
 		}
-		auto newNode = new Node(x, it, it->next);
-		it->next->prev = newNode;
-		it->next = newNode;
-		++size_;
+		return Handle{link_before(it->next, x)};
 	}
 
 	/* Remove an element from the given index 'index'*/
 	T erase(std::size_t index) {
 		if (index >= size_)
 			throw std::out_of_range("Index out of bounds (pop())");
-		auto oldhead = head;
-		for (std::size_t i = 0; i < index + 1; ++i) {
-			head = head->next;
-		}
-		auto out = pop_back();
-		head = oldhead;
-		return out;
+		return unlink(node_at(index));
 	}
 
+	/* Remove the element at 'index' if there is one. Returns false instead
+	   of throwing when 'index' is out of bounds */
+	bool try_erase(std::size_t index) {
+		if (index >= size_)
+			return false;
+		unlink(node_at(index));
+		return true;
+	}
+
+	/* Remove the element of 'position', which must belong to this list */
+	T erase(Handle position) { return unlink(position.node); }
+
 	/* Remove an element at the end of the list */
 	T pop_at_back() {
 		if (empty())
 			throw std::out_of_range("List is empty (pop_back())");
-		auto toDelete = head->prev;
-		head->prev = toDelete->prev;
-		toDelete->prev->next = head;
-		T out = toDelete->x;
-		delete toDelete;
-		--size_;
-		return out;
+		return unlink(head->prev);
 	}
 
 	/* Remove an element at the beginning of the list */
 	T pop_at_front() {
 		if (empty())
 			throw std::out_of_range("List is empty (pop_front())");
-		head = head->next;
-		return pop_back();
+		return unlink(head);
+	}
+
+	/* If 'x' is in list, then removes it. Returns false if it is not */
+	bool remove(const T& x) {
+		Handle h = find_handle(x);
+		if (!h)
+			return false;
+		unlink(h.node);
+		return true;
+	}
+
+	/* Makes the element of 'position' the first of the list */
+	void move_to_front(Handle position) {
+		move_to_back(position);
+		head = position.node;
 	}
 
-	/* If 'x' is in list, then removes it */
-	void remove(const T& x) {
-		auto it = head->next;
-		for (; it->x != x; it = it->next) {
-			if (it == head)
-				return;  // Reached end of the list
+	/* Makes the element of 'position' the last of the list */
+	void move_to_back(Handle position) {
+		Node* n = position.node;
+		if (n == head) {
+			head = head->next;
+			return;
 		}
-		auto oldhead = head;
-		head = it->next;
-		pop_back();
-		head = oldhead;
+		if (n == head->prev)
+			return;
+		n->prev->next = n->next;
+		n->next->prev = n->prev;
+		n->prev = head->prev;
+		n->next = head;
+		head->prev->next = n;
+		head->prev = n;
 	}
 
+	/* Handles of the first and the last element (empty handles if the list
+	   is empty), and of the element at 'index' */
+	Handle front_handle() const { return Handle{head}; }
+
+	Handle back_handle() const { return Handle{head ? head->prev : nullptr}; }
+
+	Handle handle_at(std::size_t index) const {
+		if (index >= size_)
+			throw std::out_of_range("Index out of bounds");
+		return Handle{node_at(index)};
+	}
+
+	/* Handles of the elements following and preceding 'position', going
+	   round the list */
+	Handle next(Handle position) const { return Handle{position.node->next}; }
+
+	Handle prev(Handle position) const { return Handle{position.node->prev}; }
+
 	/* Return true if list is empty*/
 	bool empty() const { return size_ == 0; }
 
@@ -166,30 +232,31 @@ public:
 	const T& at(std::size_t index) const {
 		if (index >= size_)
 			throw std::out_of_range("Index out of bounds");
-		auto it = head;
-		for (std::size_t i = 0; i < index; ++i) {
-			it = it->next;
-		}
-		return it->x;
+		return node_at(index)->x;
 	}
 
-	/* Return the position of element 'x' in the list */
+	/* Return the position of element 'x' in the list, size() if it is not
+	   in the list */
 	std::size_t find(const T& x) const {
-		if (size_ == 0)
-			return 0;
-
-		if (head->x == x)
-			return 0;
-
-		std::size_t index = 1;
-		for (auto it = head->next; it != head; it = it->next) {
+		std::size_t index = 0;
+		for (auto it = head; index < size_; it = it->next, ++index) {
 			if (it->x == x)
 				break;
-			++index;
 		}
 		return index;
 	}
 
+	/* Return the handle of the first element equal to 'x', an empty handle
+	   if there is none */
+	Handle find_handle(const T& x) const {
+		auto it = head;
+		for (std::size_t i = 0; i < size_; ++i, it = it->next) {
+			if (it->x == x)
+				return Handle{it};
+		}
+		return Handle{};
+	}
+
 	/* Return size of list*/
 	std::size_t size() const { return size_; }
 
@@ -213,12 +280,51 @@ private:
 		Node* next{nullptr};
 	};
 
+	/* Node at 'index', walking from whichever end is closer */
+	Node* node_at(std::size_t index) const {
+		Node* it = head;
+		if (index <= size_ / 2) {
+			for (std::size_t i = 0; i < index; ++i)
+				it = it->next;
+		} else {
+			for (std::size_t i = size_; i > index; --i)
+				it = it->prev;
+		}
+		return it;
+	}
+
+	/* Links a new node holding 'x' in front of 'position' (which may be the
+	   head, appending at the back) */
+	Node* link_before(Node* position, const T& x) {
+		auto newNode = new Node(x, position->prev, position);
+		position->prev->next = newNode;
+		position->prev = newNode;
+		++size_;
+		return newNode;
+	}
+
+	/* Unlinks and deletes node 'n', returning its element */
+	T unlink(Node* n) {
+		if (size_ == 1) {
+			head = nullptr;
+		} else {
+			n->prev->next = n->next;
+			n->next->prev = n->prev;
+			if (n == head)
+				head = n->next;
+		}
+		T out = std::move(n->x);
+		delete n;
+		--size_;
+		return out;
+	}
+
 	static Node* copy_list(const Node* other_head) {
 		Circularlist<T> copy;
-		copy.push_back(other_head->x);
+		copy.push_at_back(other_head->x);
 
 		for (auto it = other_head->next; it != other_head; it = it->next) {
-			copy.push_back(it->x);
+			copy.push_at_back(it->x);
 		}
 
 		auto p = copy.head;
@@ -0,0 +1,345 @@
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <thread>
+#include <array_list.h>
+
+namespace structures {
+
+/* Lock-free skip list ordered set (Herlihy & Shavit's LockFreeSkipList,
+ * after Fraser). insert, remove and contains may be called from any number of
+ * threads at once without a lock; contains is wait-free.
+ * A node is removed by marking its forward pointers, top level first; the
+ * thread whose mark lands on the bottom level owns the removal. Searches
+ * unlink marked nodes as they pass them.
+ * Unlinked nodes are reclaimed with epoch based reclamation: every operation
+ * runs inside an epoch, and a node retired in epoch e is freed once the
+ * global epoch reaches e + 2, when no operation that could still see it is
+ * running.
+ * param T: data type of the elements */
+template <typename T>
+class ConcurrentSkipList {
+public:
+	ConcurrentSkipList() : head{Node::create(T{}, max_level)} {}
+
+	ConcurrentSkipList(const ConcurrentSkipList<T>&) = delete;
+	ConcurrentSkipList<T>& operator=(const ConcurrentSkipList<T>&) = delete;
+
+	/* Must not run concurrently with any other operation */
+	~ConcurrentSkipList() {
+		Node* it = head;
+		while (it) {
+			Node* next = pointer(it->next[0].load());
+			Node::destroy(it);
+			it = next;
+		}
+		for (std::size_t i = 0; i < max_threads; ++i) {
+			free_retired(slots[i], static_cast<std::uint64_t>(-1));
+		}
+	}
+
+	/* Inserts 'x', returns false if it is already in the list */
+	bool insert(const T& x) {
+		Guard guard{*this};
+		Node* preds[max_level];
+		Node* succs[max_level];
+		int height = random_height();
+
+		while (true) {
+			if (find(x, preds, succs))
+				return false;
+
+			Node* n = Node::create(x, height);
+			for (int i = 0; i < height; ++i)
+				n->next[i].store(reference(succs[i]), std::memory_order_relaxed);
+			std::uintptr_t expected = reference(succs[0]);
+			if (!preds[0]->next[0].compare_exchange_strong(expected, reference(n))) {
+				Node::destroy(n);
+				continue;
+			}
+			size_.fetch_add(1);
+
+			for (int i = 1; i < height; ++i) {
+				while (true) {
+					// Stop if the node was removed while it was being linked
+					std::uintptr_t own = n->next[i].load();
+					if (marked(own))
+						goto linked;
+					if (pointer(own) != succs[i] &&
+						!n->next[i].compare_exchange_strong(own, reference(succs[i])))
+						goto linked;
+					expected = reference(succs[i]);
+					if (preds[i]->next[i].compare_exchange_strong(expected,
+																  reference(n)))
+						break;
+					find(x, preds, succs);
+					if (succs[0] != n)
+						goto linked;
+				}
+			}
+		linked:
+			release(n, guard);
+			return true;
+		}
+	}
+
+	/* Removes 'x' from the list, if it exists else return false */
+	bool remove(const T& x) {
+		Guard guard{*this};
+		Node* preds[max_level];
+		Node* succs[max_level];
+		if (!find(x, preds, succs))
+			return false;
+
+		Node* n = succs[0];
+		for (int i = n->height - 1; i > 0; --i) {
+			std::uintptr_t succ = n->next[i].load();
+			while (!marked(succ))
+				n->next[i].compare_exchange_weak(succ, succ | 1);
+		}
+		std::uintptr_t succ = n->next[0].load();
+		while (true) {
+			if (marked(succ))
+				return false;  // another thread removed it first
+			if (n->next[0].compare_exchange_strong(succ, succ | 1)) {
+				size_.fetch_sub(1);
+				release(n, guard);
+				return true;
+			}
+		}
+	}
+
+	/* Returns true if the list contains 'x' */
+	bool contains(const T& x) const {
+		Guard guard{const_cast<ConcurrentSkipList<T>&>(*this)};
+		const Node* pred = head;
+		const Node* curr = nullptr;
+		for (int i = max_level - 1; i >= 0; --i) {
+			curr = pointer(pred->next[i].load());
+			while (curr) {
+				std::uintptr_t succ = curr->next[i].load();
+				while (marked(succ)) {
+					curr = pointer(succ);
+					if (!curr)
+						break;
+					succ = curr->next[i].load();
+				}
+				if (curr && curr->x < x) {
+					pred = curr;
+					curr = pointer(succ);
+				} else {
+					break;
+				}
+			}
+		}
+		return curr && !(x < curr->x);
+	}
+
+	bool empty() const { return size() == 0; }
+
+	/* Returns the number of elements. Exact only when no update is running */
+	std::size_t size() const { return size_.load(); }
+
+	/* Returns a in-ordered list of the elements. Each element present for the
+	   whole call is included; concurrent updates may or may not be */
+	Arraylist<T> in_order() const {
+		Guard guard{const_cast<ConcurrentSkipList<T>&>(*this)};
+		Arraylist<T> out;
+		for (Node* it = pointer(head->next[0].load()); it;) {
+			std::uintptr_t next = it->next[0].load();
+			if (!marked(next))
+				out.push_at_back(it->x);
+			it = pointer(next);
+		}
+		return out;
+	}
+
+private:
+	const static int max_level{32};
+	const static std::size_t max_threads{128};
+	const static std::size_t collect_every{64};
+	const static std::uint64_t inactive{static_cast<std::uint64_t>(-1)};
+
+	/* Node with 'height' marked forward pointers allocated in the same block.
+	   The low bit of a forward pointer marks the node owning it as removed */
+	struct Node {
+		static Node* create(const T& x, int height) {
+			void* p = ::operator new(sizeof(Node) +
+									 (height - 1) * sizeof(std::atomic<std::uintptr_t>));
+			Node* n = new (p) Node(x, height);
+			for (int i = 1; i < height; ++i)
+				new (&n->next[i]) std::atomic<std::uintptr_t>(0);
+			return n;
+		}
+
+		static void destroy(Node* n) {
+			n->~Node();
+			::operator delete(n);
+		}
+
+		T x;
+		int height;
+		/* Released by the inserting and the removing thread; the last one to
+		   let go unlinks the node from every level and retires it */
+		std::atomic<int> owners{2};
+		std::uint64_t retired_epoch{0};
+		Node* retired_next{nullptr};
+		std::atomic<std::uintptr_t> next[1];
+
+	private:
+		Node(const T& x_, int height_) : x{x_}, height{height_}, next{{0}} {}
+	};
+
+	/* Per thread epoch record; a thread holds a slot for one operation */
+	struct alignas(64) Slot {
+		std::atomic<bool> in_use{false};
+		std::atomic<std::uint64_t> epoch{inactive};
+		Node* retired{nullptr};
+		std::size_t retired_count{0};
+	};
+
+	/* Enters the current epoch for the duration of one operation */
+	class Guard {
+	public:
+		explicit Guard(ConcurrentSkipList<T>& list_) : list{list_} {
+			static thread_local std::size_t hint{0};
+			std::size_t i = hint;
+			while (true) {
+				bool expected = false;
+				if (!list.slots[i].in_use.load(std::memory_order_relaxed) &&
+					list.slots[i].in_use.compare_exchange_strong(expected, true))
+					break;
+				i = (i + 1) % max_threads;
+				if (i == hint)
+					std::this_thread::yield();
+			}
+			hint = i;
+			slot = &list.slots[i];
+			slot->epoch.store(list.epoch.load());
+		}
+
+		~Guard() {
+			slot->epoch.store(inactive);
+			slot->in_use.store(false);
+		}
+
+		Guard(const Guard&) = delete;
+		Guard& operator=(const Guard&) = delete;
+
+		ConcurrentSkipList<T>& list;
+		Slot* slot;
+	};
+
+	static Node* pointer(std::uintptr_t p) {
+		return reinterpret_cast<Node*>(p & ~std::uintptr_t{1});
+	}
+
+	static bool marked(std::uintptr_t p) { return p & 1; }
+
+	static std::uintptr_t reference(const Node* n) {
+		return reinterpret_cast<std::uintptr_t>(n);
+	}
+
+	/* Fills preds/succs with the last node before 'x' and the first node not
+	   less than 'x' on every level, unlinking marked nodes on the way.
+	   Returns true if succs[0] holds 'x' */
+	bool find(const T& x, Node** preds, Node** succs) {
+	retry:
+		Node* pred = head;
+		for (int i = max_level - 1; i >= 0; --i) {
+			Node* curr = pointer(pred->next[i].load());
+			while (curr) {
+				std::uintptr_t succ = curr->next[i].load();
+				while (marked(succ)) {
+					std::uintptr_t expected = reference(curr);
+					if (!pred->next[i].compare_exchange_strong(expected,
+															   succ & ~std::uintptr_t{1}))
+						goto retry;
+					curr = pointer(succ);
+					if (!curr)
+						break;
+					succ = curr->next[i].load();
+				}
+				if (curr && curr->x < x) {
+					pred = curr;
+					curr = pointer(succ);
+				} else {
+					break;
+				}
+			}
+			preds[i] = pred;
+			succs[i] = curr;
+		}
+		return succs[0] && !(x < succs[0]->x);
+	}
+
+	/* Called once by the inserting and once by the removing thread */
+	void release(Node* n, Guard& guard) {
+		if (n->owners.fetch_sub(1) != 1)
+			return;
+		// Both are done: no level can be linked again, so one search for the
+		// key unlinks the node everywhere
+		Node* preds[max_level];
+		Node* succs[max_level];
+		find(n->x, preds, succs);
+		retire(n, *guard.slot);
+	}
+
+	void retire(Node* n, Slot& slot) {
+		n->retired_epoch = epoch.load();
+		n->retired_next = slot.retired;
+		slot.retired = n;
+		if (++slot.retired_count % collect_every == 0) {
+			try_advance();
+			std::uint64_t current = epoch.load();
+			if (current >= 2)
+				free_retired(slot, current - 2);
+		}
+	}
+
+	/* Frees the nodes of 'slot' retired in epoch 'before' or earlier */
+	static void free_retired(Slot& slot, std::uint64_t before) {
+		Node** link = &slot.retired;
+		while (*link) {
+			Node* n = *link;
+			if (n->retired_epoch <= before) {
+				*link = n->retired_next;
+				Node::destroy(n);
+			} else {
+				link = &n->retired_next;
+			}
+		}
+	}
+
+	/* Moves the global epoch on if every running operation has seen it */
+	void try_advance() {
+		std::uint64_t current = epoch.load();
+		for (std::size_t i = 0; i < max_threads; ++i) {
+			std::uint64_t e = slots[i].epoch.load();
+			if (e != inactive && e != current)
+				return;
+		}
+		epoch.compare_exchange_strong(current, current + 1);
+	}
+
+	static int random_height() {
+		static thread_local std::uint64_t seed{
+			0x9e3779b97f4a7c15ULL ^
+			std::hash<std::thread::id>{}(std::this_thread::get_id())};
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		int height = 1;
+		for (std::uint64_t r = seed; (r & 3) == 0 && height < max_level; r >>= 2)
+			++height;
+		return height;
+	}
+
+	Node* head;
+	std::atomic<std::size_t> size_{0};
+	std::atomic<std::uint64_t> epoch{0};
+	Slot slots[max_threads];
+};
+
+}
\ No newline at end of file
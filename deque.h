@@ -0,0 +1,183 @@
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace structures {
+
+/* Largest power of two number of elements of 'T' (at least 'n') that fits a
+   512 byte block */
+template <typename T>
+constexpr std::size_t deque_block_size(std::size_t n) {
+	return n * 2 * sizeof(T) <= 512 ? deque_block_size<T>(n * 2) : n;
+}
+
+/* Double ended queue made of fixed size blocks.
+ * A map (a ring of block pointers) addresses the blocks, so pushing and
+ * popping at both ends is amortized O(1), at(i) is O(1), and growing only
+ * copies block pointers: elements never move once stored. Blocks are kept
+ * for reuse when the deque shrinks and freed with it.
+ * Works as the Container of QueueWrapper and StackWrapper.
+ * param T: data type of the elements */
+template <typename T>
+class Deque {
+public:
+	Deque() = default;
+
+	Deque(const Deque<T>& other) {
+		for (std::size_t i = 0; i < other.size_; ++i)
+			push_at_back(other[i]);
+	}
+
+	Deque(Deque<T>&& other)
+		: map{std::move(other.map)}
+		, map_size{other.map_size}
+		, front_{other.front_}
+		, size_{other.size_} {
+		other.map_size = 0;
+		other.front_ = 0;
+		other.size_ = 0;
+	}
+
+	Deque<T>& operator=(const Deque<T>& other) {
+		Deque<T> copy{other};
+		swap(copy);
+		return *this;
+	}
+
+	Deque<T>& operator=(Deque<T>&& other) {
+		Deque<T> copy{std::move(other)};
+		swap(copy);
+		return *this;
+	}
+
+	~Deque() {
+		for (std::size_t i = 0; i < map_size; ++i)
+			delete[] map[i];
+	}
+
+	/* To clear all elements. Blocks are kept for reuse */
+	void clear() {
+		front_ = 0;
+		size_ = 0;
+	}
+
+	/* Add 'data' at the end */
+	void push_at_back(const T& data) {
+		reserve_one();
+		slot(front_ + size_) = data;
+		size_++;
+	}
+
+	/* Add 'data' at the beginning */
+	void push_at_front(const T& data) {
+		reserve_one();
+		front_ = (front_ + capacity() - 1) & (capacity() - 1);
+		slot(front_) = data;
+		size_++;
+	}
+
+	/* Remove the element at the end */
+	T pop_at_back() {
+		if (empty())
+			throw std::out_of_range("Deque is empty");
+		size_--;
+		return std::move(slot(front_ + size_));
+	}
+
+	/* Remove the element at the beginning */
+	T pop_at_front() {
+		if (empty())
+			throw std::out_of_range("Deque is empty");
+		T out = std::move(slot(front_));
+		front_ = (front_ + 1) & (capacity() - 1);
+		size_--;
+		return out;
+	}
+
+	/* Return True if the deque is empty */
+	bool empty() const { return size_ == 0; }
+
+	/* Return the number of elements */
+	std::size_t size() const { return size_; }
+
+	/* Check for the 'index' that it is valid and return the reference to the
+	   element at that position */
+	T& at(std::size_t index) {
+		return const_cast<T&>(static_cast<const Deque*>(this)->at(index));
+	}
+
+	const T& at(std::size_t index) const {
+		if (index >= size_)
+			throw std::out_of_range("Index out of bounds");
+		return slot(front_ + index);
+	}
+
+	T& operator[](std::size_t index) { return slot(front_ + index); }
+
+	const T& operator[](std::size_t index) const { return slot(front_ + index); }
+
+	T& front() { return slot(front_); }
+
+	const T& front() const { return slot(front_); }
+
+	T& back() { return slot(front_ + size_ - 1); }
+
+	const T& back() const { return slot(front_ + size_ - 1); }
+
+	void swap(Deque<T>& other) {
+		std::swap(map, other.map);
+		std::swap(map_size, other.map_size);
+		std::swap(front_, other.front_);
+		std::swap(size_, other.size_);
+	}
+
+private:
+	const static std::size_t block_size{deque_block_size<T>(8)};
+
+	/* Number of element slots addressed by the map */
+	std::size_t capacity() const { return map_size * block_size; }
+
+	/* Slot at position 'p' of the ring of slots (taken modulo capacity) */
+	T& slot(std::size_t p) const {
+		p &= capacity() - 1;
+		return map[p / block_size][p % block_size];
+	}
+
+	/* Makes sure one more element fits, growing the map if needed, and that
+	   the blocks at both ends are allocated.
+	   The map grows while a block is still free, so the first and the last
+	   element never share a block when it is reordered */
+	void reserve_one() {
+		if (size_ + 1 + block_size > capacity())
+			grow();
+		std::size_t back = ((front_ + size_) & (capacity() - 1)) / block_size;
+		std::size_t front = ((front_ + capacity() - 1) & (capacity() - 1)) / block_size;
+		if (!map[back])
+			map[back] = new T[block_size];
+		if (!map[front])
+			map[front] = new T[block_size];
+	}
+
+	/* Doubles the map, laying the blocks out from the front one on */
+	void grow() {
+		std::size_t new_size = map_size > 0 ? map_size * 2 : 4;
+		std::unique_ptr<T*[]> new_map{new T*[new_size]()};
+		std::size_t first = front_ / block_size;
+		for (std::size_t i = 0; i < map_size; ++i)
+			new_map[i] = map[(first + i) & (map_size - 1)];
+		front_ %= block_size;
+		map = std::move(new_map);
+		map_size = new_size;
+	}
+
+	std::unique_ptr<T*[]> map;
+	std::size_t map_size{0};
+	std::size_t front_{0};
+	std::size_t size_{0};
+};
+
+template <typename T>
+const std::size_t Deque<T>::block_size;
+
+}
\ No newline at end of file
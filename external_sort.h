@@ -0,0 +1,401 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <serialization.h>
+
+#include <unistd.h>
+
+namespace structures {
+
+/* Building blocks of Externalsorter */
+namespace external {
+
+/* Temporary binary file. It is unlinked as soon as it is created, so it
+   disappears with the object (or the process) */
+class Tempfile {
+public:
+	explicit Tempfile(const std::string& directory) {
+		std::string name = directory + "/structures-sort-XXXXXX";
+		std::unique_ptr<char[]> path{new char[name.size() + 1]};
+		std::copy(name.begin(), name.end(), path.get());
+		path[name.size()] = '\0';
+		int fd = ::mkstemp(path.get());
+		if (fd < 0)
+			throw std::runtime_error("Cannot create a temporary file in " + directory);
+		::unlink(path.get());
+		file = ::fdopen(fd, "w+b");
+		if (!file) {
+			::close(fd);
+			throw std::runtime_error("Cannot open a temporary file");
+		}
+	}
+
+	Tempfile(const Tempfile&) = delete;
+	Tempfile& operator=(const Tempfile&) = delete;
+
+	~Tempfile() { std::fclose(file); }
+
+	void write(const void* data, std::size_t bytes) {
+		if (std::fwrite(data, 1, bytes, file) != bytes)
+			throw std::runtime_error("Cannot write a temporary file");
+	}
+
+	/* Reads up to 'bytes' bytes, returns the number read */
+	std::size_t read(void* data, std::size_t bytes) {
+		return std::fread(data, 1, bytes, file);
+	}
+
+	void rewind() {
+		std::fflush(file);
+		std::rewind(file);
+	}
+
+private:
+	std::FILE* file;
+};
+
+/* Reads one sorted run back through two buffers: while the elements of one
+   are consumed, the next block of the run is read into the other in the
+   background */
+template <typename T>
+class Runreader {
+public:
+	Runreader(std::unique_ptr<Tempfile> file_, std::size_t buffer_size)
+		: file{std::move(file_)}
+		, capacity{buffer_size}
+		, current{new T[buffer_size]}
+		, ahead{new T[buffer_size]} {
+		file->rewind();
+		read_ahead();
+		refill();
+	}
+
+	Runreader(const Runreader&) = delete;
+	Runreader& operator=(const Runreader&) = delete;
+
+	~Runreader() {
+		if (pending.valid())
+			pending.wait();
+	}
+
+	bool done() const { return pos == len; }
+
+	const T& head() const { return current[pos]; }
+
+	void advance() {
+		if (++pos == len)
+			refill();
+	}
+
+private:
+	void read_ahead() {
+		T* into = ahead.get();
+		Tempfile* from = file.get();
+		std::size_t bytes = capacity * sizeof(T);
+		pending = std::async(std::launch::async, [=] {
+			return from->read(into, bytes) / sizeof(T);
+		});
+	}
+
+	void refill() {
+		pos = 0;
+		len = pending.valid() ? pending.get() : 0;
+		std::swap(current, ahead);
+		if (len == capacity)
+			read_ahead();
+	}
+
+	std::unique_ptr<Tempfile> file;
+	std::size_t capacity;
+	std::unique_ptr<T[]> current;
+	std::unique_ptr<T[]> ahead;
+	std::future<std::size_t> pending;
+	std::size_t pos{0};
+	std::size_t len{0};
+};
+
+/* Tournament tree of losers over k sources: the winner (smallest head) is
+   found in O(1) and replaced in log2(k) comparisons, one per level, against
+   the loser stored there. Exhausted sources lose to everything; ties go to
+   the lower source, which keeps the merge stable */
+template <typename Less>
+class Losertree {
+public:
+	Losertree(std::size_t k_, Less less_)
+		: k{k_}, tree{new std::size_t[k_ > 0 ? k_ : 1]}, less{less_} {
+		if (k > 0)
+			tree[0] = build(1);
+	}
+
+	/* Source holding the smallest head */
+	std::size_t winner() const { return tree[0]; }
+
+	/* Replays the path of the winner after its head changed */
+	void replay() {
+		std::size_t w = tree[0];
+		for (std::size_t node = (w + k) / 2; node > 0; node /= 2) {
+			if (beats(tree[node], w))
+				std::swap(tree[node], w);
+		}
+		tree[0] = w;
+	}
+
+private:
+	bool beats(std::size_t a, std::size_t b) const {
+		if (less(a, b))
+			return true;
+		return !less(b, a) && a < b;
+	}
+
+	std::size_t build(std::size_t node) {
+		if (node >= k)
+			return node - k;
+		std::size_t l = build(2 * node);
+		std::size_t r = build(2 * node + 1);
+		if (beats(r, l)) {
+			tree[node] = l;
+			return r;
+		}
+		tree[node] = r;
+		return l;
+	}
+
+	std::size_t k;
+	std::unique_ptr<std::size_t[]> tree;
+	Less less;
+};
+
+}  // namespace external
+
+/* External merge sort for trivially copyable elements, for data that does
+ * not fit in memory.
+ * Elements are pushed into a buffer of at most 'memory' bytes; every time it
+ * fills up it is sorted and written to a temporary file as one run, in a
+ * single sequential write. finish() merges the runs with a loser tree,
+ * reading every run ahead in the background, and streams the result; when
+ * there are more runs than the memory allows buffers for, groups of runs are
+ * merged into longer runs first. Memory use stays within the budget (plus
+ * small per-run bookkeeping).
+ * write_sorted() stores the result in the sorted file format of
+ * serialization.h, ready to be memory mapped through Frozentree or loaded
+ * into a Tree with read_binary.
+ * param T: data type of the elements
+ * param Compare: strict weak ordering of the elements */
+template <typename T, typename Compare = std::less<T>>
+class Externalsorter {
+	static_assert(std::is_trivially_copyable<T>::value,
+				  "External sorting needs trivially copyable elements");
+
+public:
+	/* Sorted sequence produced by finish(), read front to back once */
+	class Stream {
+	public:
+		/* Moves the next element into 'x', returns false once all were read */
+		bool next(T& x) {
+			if (!runs.empty()) {
+				auto& run = *runs[tree->winner()];
+				if (run.done())
+					return false;
+				x = run.head();
+				run.advance();
+				tree->replay();
+				return true;
+			}
+			if (pos == size)
+				return false;
+			x = memory[pos++];
+			return true;
+		}
+
+	private:
+		friend class Externalsorter<T, Compare>;
+
+		using Reader = std::unique_ptr<external::Runreader<T>>;
+
+		/* Compares the heads of two runs. Points into the vector's storage,
+		   which stays put when the stream is moved */
+		struct Less {
+			bool operator()(std::size_t a, std::size_t b) const {
+				const auto& x = *runs[a];
+				const auto& y = *runs[b];
+				if (x.done())
+					return false;
+				return y.done() || comp(x.head(), y.head());
+			}
+			const Reader* runs;
+			Compare comp;
+		};
+
+		Stream(std::unique_ptr<T[]> memory_, std::size_t size_)
+			: memory{std::move(memory_)}, size{size_} {}
+
+		Stream(std::vector<Reader> runs_, Compare comp_)
+			: runs{std::move(runs_)}
+			, tree{new external::Losertree<Less>{runs.size(), Less{runs.data(), comp_}}} {}
+
+		std::unique_ptr<T[]> memory;
+		std::size_t pos{0};
+		std::size_t size{0};
+		std::vector<Reader> runs;
+		std::unique_ptr<external::Losertree<Less>> tree;
+	};
+
+	/* Sorts within 'memory' bytes, spilling runs into 'directory' */
+	explicit Externalsorter(std::size_t memory = std::size_t{256} << 20,
+							std::string directory = "/tmp",
+							Compare comp_ = Compare{})
+		: budget{memory > 2 * min_buffer ? memory : 2 * min_buffer}
+		, temp{std::move(directory)}
+		, comp{comp_}
+		, capacity{budget / sizeof(T)} {}
+
+	/* Adds 'x' to the data to sort */
+	void push(const T& x) {
+		if (!buffer)
+			buffer.reset(new T[capacity]);
+		else if (size == capacity)
+			spill();
+		buffer[size++] = x;
+		total++;
+	}
+
+	/* Adds every element of 'list' (an Arraylist or any list with size() and
+	   operator[]) */
+	template <typename List>
+	void push_all(const List& list) {
+		for (std::size_t i = 0; i < list.size(); ++i)
+			push(list[i]);
+	}
+
+	/* Number of elements pushed */
+	std::size_t count() const { return total; }
+
+	/* Returns the sorted elements as a stream. The sorter is left empty */
+	Stream finish() {
+		if (runs.empty()) {
+			std::sort(buffer.get(), buffer.get() + size, comp);
+			Stream out{std::move(buffer), size};
+			reset();
+			return out;
+		}
+		spill();
+		buffer.reset();
+
+		// Merge groups of runs until one pass can read all of them
+		std::size_t fanin = (budget / min_buffer - 1) / 2;
+		if (fanin < 2)
+			fanin = 2;
+		while (runs.size() > fanin) {
+			std::vector<std::unique_ptr<external::Tempfile>> merged;
+			for (std::size_t i = 0; i < runs.size(); i += fanin) {
+				std::size_t end = std::min(i + fanin, runs.size());
+				merged.push_back(merge(i, end));
+			}
+			runs = std::move(merged);
+		}
+		Stream out{open(0, runs.size()), comp};
+		reset();
+		return out;
+	}
+
+	/* Sorts everything pushed into 'path', in the sorted file format of
+	   serialization.h. The sorter is left empty */
+	void write_sorted(const std::string& path) {
+		using namespace serialization;
+		std::ofstream out{path, std::ios::binary};
+		if (!out)
+			throw std::runtime_error("Cannot open " + path);
+		std::size_t n = total;
+		write_header<T>(out, Kind::sorted, n, n);
+		Stream sorted = finish();
+		std::size_t chunk_size = min_buffer / sizeof(T) + 1;
+		std::unique_ptr<T[]> chunk{new T[chunk_size]};
+		std::size_t len = 0;
+		for (T x; sorted.next(x);) {
+			chunk[len++] = x;
+			if (len == chunk_size) {
+				write_elements(out, chunk.get(), len);
+				len = 0;
+			}
+		}
+		write_elements(out, chunk.get(), len);
+		if (!out)
+			throw std::runtime_error("Cannot write " + path);
+	}
+
+private:
+	/* Smallest read or write buffer worth a disk request */
+	const static std::size_t min_buffer{std::size_t{64} << 10};
+
+	/* Sorts the buffer and writes it out as a new run */
+	void spill() {
+		std::sort(buffer.get(), buffer.get() + size, comp);
+		std::unique_ptr<external::Tempfile> file{new external::Tempfile{temp}};
+		file->write(buffer.get(), size * sizeof(T));
+		runs.push_back(std::move(file));
+		size = 0;
+	}
+
+	/* Readers for runs [first, last), sharing the budget: two buffers each,
+	   and one more buffer's worth left for the output */
+	std::vector<std::unique_ptr<external::Runreader<T>>> open(std::size_t first,
+															   std::size_t last) {
+		std::size_t per_buffer = budget / (2 * (last - first) + 1) / sizeof(T);
+		if (per_buffer == 0)
+			per_buffer = 1;
+		std::vector<std::unique_ptr<external::Runreader<T>>> readers;
+		for (std::size_t i = first; i < last; ++i)
+			readers.emplace_back(new external::Runreader<T>{std::move(runs[i]), per_buffer});
+		return readers;
+	}
+
+	/* Merges runs [first, last) into one new run */
+	std::unique_ptr<external::Tempfile> merge(std::size_t first, std::size_t last) {
+		std::size_t per_buffer = budget / (2 * (last - first) + 1) / sizeof(T);
+		if (per_buffer == 0)
+			per_buffer = 1;
+		Stream in{open(first, last), comp};
+		std::unique_ptr<external::Tempfile> out{new external::Tempfile{temp}};
+		std::unique_ptr<T[]> chunk{new T[per_buffer]};
+		std::size_t len = 0;
+		for (T x; in.next(x);) {
+			chunk[len++] = x;
+			if (len == per_buffer) {
+				out->write(chunk.get(), len * sizeof(T));
+				len = 0;
+			}
+		}
+		out->write(chunk.get(), len * sizeof(T));
+		return out;
+	}
+
+	void reset() {
+		runs.clear();
+		buffer.reset();
+		size = 0;
+		total = 0;
+	}
+
+	std::size_t budget;
+	std::string temp;
+	Compare comp;
+	std::size_t capacity;
+	std::unique_ptr<T[]> buffer;
+	std::size_t size{0};
+	std::size_t total{0};
+	std::vector<std::unique_ptr<external::Tempfile>> runs;
+};
+
+template <typename T, typename Compare>
+const std::size_t Externalsorter<T, Compare>::min_buffer;
+
+}
\ No newline at end of file
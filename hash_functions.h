@@ -0,0 +1,220 @@
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+namespace structures {
+
+/* Hash functions and bucket reductions for Hashtablewrapper */
+namespace hashing {
+
+/* 64 bit avalanche finalizer (murmur3 fmix64): every input bit affects
+   every output bit, which fixes identity hashes of integers */
+inline std::uint64_t mix(std::uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+/* 64x64 -> 128 bit multiply, folded back to 64 bits by xor */
+inline std::uint64_t mum(std::uint64_t a, std::uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+	return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+	std::uint64_t ha = a >> 32, hb = b >> 32;
+	std::uint64_t la = static_cast<std::uint32_t>(a);
+	std::uint64_t lb = static_cast<std::uint32_t>(b);
+	std::uint64_t hi = ha * hb, lo = la * lb;
+	std::uint64_t rm0 = ha * lb, rm1 = hb * la;
+	std::uint64_t t = lo + (rm0 << 32);
+	std::uint64_t c = t < lo;
+	lo = t + (rm1 << 32);
+	c += lo < t;
+	hi += (rm0 >> 32) + (rm1 >> 32) + c;
+	return lo ^ hi;
+#endif
+}
+
+inline std::uint64_t read64(const unsigned char* p) {
+	std::uint64_t v;
+	std::memcpy(&v, p, 8);
+	return v;
+}
+
+inline std::uint64_t read32(const unsigned char* p) {
+	std::uint32_t v;
+	std::memcpy(&v, p, 4);
+	return v;
+}
+
+/* wyhash style hash of 'len' bytes at 'data' */
+inline std::uint64_t bytes(const void* data, std::size_t len,
+						   std::uint64_t seed = 0) {
+	const std::uint64_t s0 = 0xa0761d6478bd642fULL;
+	const std::uint64_t s1 = 0xe7037ed1a0b428dbULL;
+	const std::uint64_t s2 = 0x8ebc6af09c88c6e3ULL;
+
+	auto p = static_cast<const unsigned char*>(data);
+	seed ^= s0;
+	std::uint64_t a, b;
+	if (len <= 16) {
+		if (len >= 4) {
+			a = (read32(p) << 32) | read32(p + ((len >> 3) << 2));
+			b = (read32(p + len - 4) << 32) |
+				read32(p + len - 4 - ((len >> 3) << 2));
+		} else if (len > 0) {
+			a = (static_cast<std::uint64_t>(p[0]) << 16) |
+				(static_cast<std::uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		std::size_t i = len;
+		if (i > 48) {
+			std::uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = mum(read64(p) ^ s1, read64(p + 8) ^ seed);
+				see1 = mum(read64(p + 16) ^ s2, read64(p + 24) ^ see1);
+				see2 = mum(read64(p + 32) ^ s0, read64(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while (i > 16) {
+			seed = mum(read64(p) ^ s1, read64(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		a = read64(p + i - 16);
+		b = read64(p + i - 8);
+	}
+	return mum(s1 ^ len, mum(a ^ s1, b ^ seed));
+}
+
+}  // namespace hashing
+
+/* std::hash followed by an avalanche finalizer */
+template <typename T>
+struct Mixhash {
+	std::size_t operator()(const T& x) const {
+		return static_cast<std::size_t>(hashing::mix(std::hash<T>{}(x)));
+	}
+};
+
+/* Types whose bytes Wyhash may hash as they are: equal values must have
+   equal bytes, so no padding and no floating point members. Specialize it
+   to std::true_type to opt a type in. Under C++17 every type with unique
+   object representations is in */
+template <typename T>
+struct Hashbytes
+#if defined(__cpp_lib_has_unique_object_representations)
+	: std::integral_constant<bool, std::has_unique_object_representations<T>::value> {
+#else
+	: std::false_type {
+#endif
+};
+
+/* wyhash style hash for strings, integers, enums, floats and doubles, and
+   the bytes of types opted in through Hashbytes */
+struct Wyhash {
+	std::size_t operator()(const std::string& x) const {
+		return static_cast<std::size_t>(hashing::bytes(x.data(), x.size()));
+	}
+
+	std::size_t operator()(const char* x) const {
+		return static_cast<std::size_t>(hashing::bytes(x, std::strlen(x)));
+	}
+
+	template <typename T>
+	typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value,
+							std::size_t>::type
+	operator()(const T& x) const {
+		return static_cast<std::size_t>(hashing::bytes(&x, sizeof(T)));
+	}
+
+	/* -0.0 == 0.0, so zero is always hashed as +0.0. long double is left
+	   out, as its storage has padding bytes */
+	template <typename T>
+	typename std::enable_if<std::is_floating_point<T>::value &&
+								!std::is_same<T, long double>::value,
+							std::size_t>::type
+	operator()(T x) const {
+		if (x == 0)
+			x = 0;
+		return static_cast<std::size_t>(hashing::bytes(&x, sizeof(T)));
+	}
+
+	template <typename T>
+	typename std::enable_if<!std::is_arithmetic<T>::value && !std::is_enum<T>::value &&
+								Hashbytes<T>::value,
+							std::size_t>::type
+	operator()(const T& x) const {
+		static_assert(std::is_trivially_copyable<T>::value,
+					  "Hashbytes types must be trivially copyable");
+		return static_cast<std::size_t>(hashing::bytes(&x, sizeof(T)));
+	}
+};
+
+/* Bucket reductions: map a full hash onto [0, buckets). Constructed again
+   every time the table changes its number of buckets */
+
+/* h % buckets: works for any bucket count, costs a division */
+struct Moduloreduce {
+	explicit Moduloreduce(std::size_t buckets_) : buckets{buckets_} {}
+	std::size_t operator()(std::size_t h) const { return h % buckets; }
+
+	std::size_t buckets;
+};
+
+/* Low bits of the hash: power of two bucket counts only, and needs a well
+   mixed hash such as Mixhash or Wyhash */
+struct Maskreduce {
+	explicit Maskreduce(std::size_t buckets) : mask{buckets - 1} {}
+	std::size_t operator()(std::size_t h) const { return h & mask; }
+
+	std::size_t mask;
+};
+
+/* Fibonacci (multiply-shift) hashing: high bits of h * 2^64/phi. Power of two
+   bucket counts only, and spreads even identity hashes of integers */
+struct Fibonaccireduce {
+	explicit Fibonaccireduce(std::size_t buckets) {
+		unsigned bits = 0;
+		while ((std::size_t{1} << bits) < buckets)
+			++bits;
+		shift = 64 - bits;
+	}
+
+	std::size_t operator()(std::size_t h) const {
+		return static_cast<std::size_t>(
+			(static_cast<std::uint64_t>(h) * 11400714819323198485ULL) >> shift);
+	}
+
+	unsigned shift;
+};
+
+/* Lemire's fastrange: (h * buckets) >> 64. Any bucket count, no division,
+   uses the high bits of the hash */
+struct Fastrangereduce {
+	explicit Fastrangereduce(std::size_t buckets_) : buckets{buckets_} {}
+
+	std::size_t operator()(std::size_t h) const {
+#if defined(__SIZEOF_INT128__)
+		return static_cast<std::size_t>(
+			(static_cast<unsigned __int128>(h) * buckets) >> 64);
+#else
+		return h % buckets;
+#endif
+	}
+
+	std::size_t buckets;
+};
+
+}
\ No newline at end of file
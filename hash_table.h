@@ -1,58 +1,76 @@
 #include <functional>
 #include <array_list.h>
-#include <linked_list.h>
+#include <bloom_filter.h>
 #include <utils.h>
 
 namespace structures {
 
 /* HashTable implementation
    params T: Data type of the elements
-   param Hash: Class that implements the hash function */
-template <typename T, typename Hash = std::hash<T>>
+   param Hash: Class that implements the hash function
+   param Reduce: Maps a hash onto a bucket (see hash_functions.h). Bucket
+   counts are always powers of two, so any of the reductions can be used
+   param Filter: Approximate membership filter checked by contains() before
+   the buckets, e.g. Bloomfilter<T, Hash>: most misses are then rejected
+   from one cache line without walking a chain. It is rebuilt from the
+   cached hashes whenever the table is resized, or once removed keys make up
+   an eighth of it. Nofilter (the default) costs nothing
+
+   Buckets use intrusive chaining: the bucket array holds the first entry of
+   every chain inline and the overflow entries come from a per-table node pool.
+   Each entry caches the full hash of its element, so rehashing never calls
+   the hash function again and most mismatches are rejected without calling
+   operator== */
+template <typename T, typename Hash = std::hash<T>,
+		  typename Reduce = Fibonaccireduce, typename Filter = Nofilter>
 class Hashtablewrapper {
 public:
 	Hashtablewrapper() = default;
 
-	Hashtablewrapper(const Hashtablewrapper<T>& other)
+	Hashtablewrapper(const Hashtablewrapper<T, Hash, Reduce, Filter>& other)
 		: Hashtablewrapper(other.buckets_size) {
+		filter_ = other.filter_;
 		auto list = other.items();
 		for (std::size_t i = 0; i < list.size(); i++) {
 			insert(list[i]);
 		}
 	}
 
-	Hashtablewrapper(Hashtablewrapper<T>&& other)
+	Hashtablewrapper(Hashtablewrapper<T, Hash, Reduce, Filter>&& other)
 		: buckets{std::move(other.buckets)}
 		, buckets_size{std::move(other.buckets_size)}
-		, _size{std::move(other._size)} {}
+		, _size{std::move(other._size)}
+		, pool{std::move(other.pool)}
+		, reducef{other.reducef}
+		, filter_{std::move(other.filter_)}
+		, stale{other.stale} {}
 
-	Hashtablewrapper<T>& operator=(const Hashtablewrapper<T>& other) {
-		Hashtablewrapper<T> copy{other};
-		std::swap(buckets_size, copy.buckets_size);
-		std::swap(buckets, copy.buckets);
-		std::swap(_size, copy._size);
+	Hashtablewrapper<T, Hash, Reduce, Filter>& operator=(
+		const Hashtablewrapper<T, Hash, Reduce, Filter>& other) {
+		Hashtablewrapper<T, Hash, Reduce, Filter> copy{other};
+		swap(copy);
 		return *this;
 	}
 
-	Hashtablewrapper<T>& operator=(Hashtablewrapper<T>&& other) {
-		Hashtablewrapper<T> copy{std::move(other)};
-		std::swap(buckets_size, copy.buckets_size);
-		std::swap(buckets, copy.buckets);
-		std::swap(_size, copy._size);
+	Hashtablewrapper<T, Hash, Reduce, Filter>& operator=(
+		Hashtablewrapper<T, Hash, Reduce, Filter>&& other) {
+		Hashtablewrapper<T, Hash, Reduce, Filter> copy{std::move(other)};
+		swap(copy);
 		return *this;
 	}
 
 	~Hashtablewrapper() = default;
 
-	/* Inserts the element 'x' into the respective bucket of the table. 
-	   If needed, it grows the table. Returns false if element is already in the 
+	/* Inserts the element 'x' into the respective bucket of the table.
+	   If needed, it grows the table. Returns false if element is already in the
 	   table (unique elements) */
 	bool insert(const T& x) {
-		auto& bucket = buckets[hash(x)];
-		if (bucket.contains(x)) {
+		std::size_t h = hashf(x);
+		if (find_entry(x, h)) {
 			return false;
 		} else {
-			bucket.push_front(x);
+			place(x, h);
+			filter_.insert_hash(h);
 			_size++;
 
 			if (_size == buckets_size) {
@@ -65,78 +83,327 @@ public:
 
 	/* Removes `x` from the table. Return true if x is found, else return false. */
 	bool remove(const T& x) {
-		try {
-			auto& bucket = buckets[hash(x)];
-			auto i = bucket.find(x);
-			bucket.erase(i);
-			_size--;
-
-			if (_size <= buckets_size / 4) {
-				std::size_t new_size = buckets_size / 2;
-				if (new_size >= starting_size)
-					resize_table(new_size);
+		std::size_t h = hashf(x);
+		Entry& bucket = buckets[index(h)];
+		if (!bucket.used)
+			return false;
+
+		if (bucket.matches(x, h)) {
+			if (bucket.next) {
+				Entry* first = bucket.next;
+				bucket.x = std::move(first->x);
+				bucket.hash = first->hash;
+				bucket.next = first->next;
+				pool.release(first);
+			} else {
+				bucket.x = T{};
+				bucket.used = false;
 			}
+		} else {
+			Entry* prev = &bucket;
+			while (prev->next && !prev->next->matches(x, h))
+				prev = prev->next;
+			if (!prev->next)
+				return false;
 
-			return true;
-		} catch (const std::out_of_range& e) {
-			return false;
+			Entry* removed = prev->next;
+			prev->next = removed->next;
+			pool.release(removed);
+		}
+		_size--;
+
+		if (_size <= buckets_size / 4 && buckets_size / 2 >= starting_size) {
+			resize_table(buckets_size / 2);
+		} else if (Filter::enabled && ++stale * 8 > _size) {
+			rebuild_filter();
 		}
+
+		return true;
 	}
 
 	/* Returns true if the element 'x' is in the table */
 	bool contains(const T& x) const {
-		return buckets[hash(x)].contains(x);
+		std::size_t h = hashf(x);
+		if (!filter_.contains_hash(h))
+			return false;
+		if (find_entry(x, h))
+			return true;
+		filter_.record_false_positive();
+		return false;
+	}
+
+	/* Looks up keys[0..n) at once: out[i] points to the element equal to
+	   keys[i], or is nullptr. Keys go in groups of 'batch': the whole group
+	   is hashed and its buckets prefetched first, then the buckets are
+	   probed and the chains that go on are prefetched, then the chains are
+	   walked, so the cache misses of a group overlap. The filter is skipped,
+	   as it would add a miss of its own ahead of an already fetched bucket */
+	void find_many(const T* keys, std::size_t n, const T** out) const {
+		const static std::size_t batch{16};
+		std::size_t hashes[batch];
+		const Entry* chain[batch];
+		for (std::size_t base = 0; base < n; base += batch) {
+			std::size_t m = n - base < batch ? n - base : batch;
+			const T* x = keys + base;
+			for (std::size_t i = 0; i < m; i++) {
+				hashes[i] = hashf(x[i]);
+				__builtin_prefetch(&buckets[index(hashes[i])]);
+			}
+			for (std::size_t i = 0; i < m; i++) {
+				const Entry& bucket = buckets[index(hashes[i])];
+				chain[i] = nullptr;
+				out[base + i] = nullptr;
+				if (!bucket.used)
+					continue;
+				if (bucket.matches(x[i], hashes[i])) {
+					out[base + i] = &bucket.x;
+				} else if (bucket.next) {
+					chain[i] = bucket.next;
+					__builtin_prefetch(chain[i]);
+				}
+			}
+			for (std::size_t i = 0; i < m; i++) {
+				for (const Entry* e = chain[i]; e; e = e->next) {
+					if (e->matches(x[i], hashes[i])) {
+						out[base + i] = &e->x;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	/* out[i] = contains(keys[i]) for keys[0..n), see find_many */
+	void contains_many(const T* keys, std::size_t n, bool* out) const {
+		const static std::size_t chunk{256};
+		const T* found[chunk];
+		for (std::size_t base = 0; base < n; base += chunk) {
+			std::size_t m = n - base < chunk ? n - base : chunk;
+			find_many(keys + base, m, found);
+			for (std::size_t i = 0; i < m; i++)
+				out[base + i] = found[i] != nullptr;
+		}
 	}
 
 	void clear() {
-		Hashtablewrapper<T> ht;
+		Hashtablewrapper<T, Hash, Reduce, Filter> ht;
+		ht.filter_ = std::move(filter_);
+		ht.filter_.reset(starting_size);
 		*this = std::move(ht);
 	}
 
+	/* The filter in front of the table, for its counters */
+	const Filter& filter() const { return filter_; }
+
+	/* Sets the false positive rate of the filter and rebuilds it */
+	void set_filter_rate(double rate) {
+		filter_.set_rate(rate);
+		rebuild_filter();
+	}
+
 	std::size_t size() const { return _size; }
 
 	/* Returns a list of items that are in the table */
 	Arraylist<T> items() const {
-		Arraylist<T> al{_size};
+		Arraylist<T> al{_size + 1};
 
 		for (std::size_t i = 0; i < buckets_size; i++) {
-			for (std::size_t j = 0; j < buckets[i].size(); j++) {
-				al.push_back(buckets[i].at(j));
+			if (!buckets[i].used)
+				continue;
+			for (const Entry* e = &buckets[i]; e; e = e->next) {
+				al.push_at_back(e->x);
 			}
 		}
 
-		return std::move(al);
+		return al;
 	}
 
 private:
+	struct Entry {
+		bool matches(const T& x_, std::size_t hash_) const {
+			return hash == hash_ && x == x_;
+		}
+
+		T x{};
+		std::size_t hash{0u};
+		Entry* next{nullptr};
+		bool used{false};
+	};
+
+	/* Hands out overflow entries from blocks of 'block_size' entries and
+	   recycles released ones through a free list */
+	class Nodepool {
+	public:
+		Nodepool() = default;
+		Nodepool(const Nodepool&) = delete;
+		Nodepool& operator=(const Nodepool&) = delete;
+
+		Nodepool(Nodepool&& other)
+			: blocks{other.blocks}, free_list{other.free_list} {
+			other.blocks = nullptr;
+			other.free_list = nullptr;
+		}
+
+		Nodepool& operator=(Nodepool&& other) {
+			std::swap(blocks, other.blocks);
+			std::swap(free_list, other.free_list);
+			return *this;
+		}
+
+		~Nodepool() {
+			while (blocks) {
+				Block* next = blocks->next;
+				delete blocks;
+				blocks = next;
+			}
+		}
+
+		Entry* acquire() {
+			if (!free_list) {
+				Block* block = new Block;
+				block->next = blocks;
+				blocks = block;
+				for (std::size_t i = 0; i < block_size; i++) {
+					block->entries[i].next = free_list;
+					free_list = &block->entries[i];
+				}
+			}
+			Entry* e = free_list;
+			free_list = e->next;
+			e->next = nullptr;
+			return e;
+		}
+
+		void release(Entry* e) {
+			e->x = T{};
+			e->next = free_list;
+			free_list = e;
+		}
+
+	private:
+		const static std::size_t block_size{64};
+
+		struct Block {
+			Entry entries[block_size];
+			Block* next{nullptr};
+		};
+
+		Block* blocks{nullptr};
+		Entry* free_list{nullptr};
+	};
+
 	explicit Hashtablewrapper(std::size_t buckets_size_)
-		: buckets{new LinkedList<T>[buckets_size_]}
-		, buckets_size{buckets_size_} {}
+		: buckets{new Entry[buckets_size_]}
+		, buckets_size{buckets_size_}
+		, reducef{buckets_size_}
+		, filter_{buckets_size_} {}
+
+	std::size_t index(std::size_t h) const { return reducef(h); }
+
+	const Entry* find_entry(const T& x, std::size_t h) const {
+		const Entry& bucket = buckets[index(h)];
+		if (!bucket.used)
+			return nullptr;
+		for (const Entry* e = &bucket; e; e = e->next) {
+			if (e->matches(x, h))
+				return e;
+		}
+		return nullptr;
+	}
 
-	std::size_t hash(const T& x) const { return hashf(x) % buckets_size; }
+	/* Stores 'x' (already known to be absent) with its cached hash 'h' */
+	template <typename U>
+	void place(U&& x, std::size_t h) {
+		Entry& bucket = buckets[index(h)];
+		if (!bucket.used) {
+			bucket.x = std::forward<U>(x);
+			bucket.hash = h;
+			bucket.used = true;
+		} else {
+			Entry* e = pool.acquire();
+			e->x = std::forward<U>(x);
+			e->hash = h;
+			e->next = bucket.next;
+			bucket.next = e;
+		}
+	}
 
+	/* Rehashes every entry by its cached hash. Overflow entries are relinked
+	   rather than reallocated */
 	void resize_table(std::size_t new_size) {
-		Hashtablewrapper new_ht{new_size};
+		std::unique_ptr<Entry[]> old{new Entry[new_size]};
+		std::swap(old, buckets);
+		std::size_t old_size = buckets_size;
+		buckets_size = new_size;
+		reducef = Reduce{new_size};
 
-		auto list = items();
-		for (std::size_t i = 0; i < list.size(); i++) {
-			new_ht.insert(list.at(i));
+		for (std::size_t i = 0; i < old_size; i++) {
+			if (!old[i].used)
+				continue;
+			Entry* e = old[i].next;
+			place(std::move(old[i].x), old[i].hash);
+			while (e) {
+				Entry* next = e->next;
+				relink(e);
+				e = next;
+			}
 		}
+		rebuild_filter();
+	}
+
+	/* Refills the filter from the cached hashes, dropping removed keys */
+	void rebuild_filter() {
+		if (!Filter::enabled)
+			return;
+		filter_.reset(buckets_size);
+		for (std::size_t i = 0; i < buckets_size; i++) {
+			if (!buckets[i].used)
+				continue;
+			for (const Entry* e = &buckets[i]; e; e = e->next)
+				filter_.insert_hash(e->hash);
+		}
+		stale = 0;
+	}
+
+	void relink(Entry* e) {
+		Entry& bucket = buckets[index(e->hash)];
+		if (!bucket.used) {
+			bucket.x = std::move(e->x);
+			bucket.hash = e->hash;
+			bucket.used = true;
+			pool.release(e);
+		} else {
+			e->next = bucket.next;
+			bucket.next = e;
+		}
+	}
 
-		*this = std::move(new_ht);
+	void swap(Hashtablewrapper<T, Hash, Reduce, Filter>& other) {
+		std::swap(buckets_size, other.buckets_size);
+		std::swap(buckets, other.buckets);
+		std::swap(_size, other._size);
+		std::swap(pool, other.pool);
+		std::swap(reducef, other.reducef);
+		std::swap(filter_, other.filter_);
+		std::swap(stale, other.stale);
 	}
 
 	const static std::size_t starting_size{8};
 
-	std::unique_ptr<LinkedList<T>[]> buckets =
-		get_unique_ptr<LinkedList<T>[]>(starting_size);
+	std::unique_ptr<Entry[]> buckets =
+		get_unique_ptr<Entry[]>(starting_size);
 	std::size_t buckets_size{starting_size};
 	std::size_t _size{0};
+	Nodepool pool;
 
 	Hash hashf{};
+	Reduce reducef{starting_size};
+	Filter filter_{starting_size};
+	/* Removed keys still set in the filter */
+	std::size_t stale{0};
 };
 
 template <typename T>
 class HashTable : public Hashtablewrapper<T> {};
 
-} 
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,317 @@
+#include <iostream>
+#include <utility>
+#include <tree.h>
+
+namespace structures {
+
+/* Closed interval [low, high]. Intervals are ordered by low end, then by
+   high end */
+template <typename T>
+struct Interval {
+	T low;
+	T high;
+
+	/* Returns true if the interval shares at least one point with [a, b] */
+	bool overlaps(const T& a, const T& b) const {
+		return !(b < low) && !(high < a);
+	}
+
+	/* Returns true if 'point' lies in the interval */
+	bool contains(const T& point) const { return overlaps(point, point); }
+
+	bool operator<(const Interval<T>& other) const {
+		return low < other.low || (!(other.low < low) && high < other.high);
+	}
+
+	bool operator>(const Interval<T>& other) const { return other < *this; }
+
+	bool operator==(const Interval<T>& other) const {
+		return !(*this < other) && !(other < *this);
+	}
+
+	bool operator!=(const Interval<T>& other) const { return !(*this == other); }
+};
+
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const Interval<T>& x) {
+	return out << "[" << x.low << ", " << x.high << "]";
+}
+
+/* Interval tree node: an AVL node that also keeps the largest high end of
+   its subtree ('max_end'), which lets searches skip subtrees ending before
+   the query starts */
+template <typename T>
+struct IntervalNode {
+	explicit IntervalNode(const Interval<T>& data_)
+		: data{data_}, max_end{data_.high} {}
+
+	virtual ~IntervalNode() {
+		delete left;
+		delete right;
+	}
+
+	bool contains(const Interval<T>& data_) const {
+		const IntervalNode* it = this;
+		while (it) {
+			if (data_ < it->data)
+				it = it->left;
+			else if (it->data < data_)
+				it = it->right;
+			else
+				return true;
+		}
+		return false;
+	}
+
+	void pre_order(Arraylist<Interval<T>>& v) const {
+		v.push_at_back(data);
+		if (left)
+			left->pre_order(v);
+		if (right)
+			right->pre_order(v);
+	}
+
+	void in_order(Arraylist<Interval<T>>& v) const {
+		if (left)
+			left->in_order(v);
+		v.push_at_back(data);
+		if (right)
+			right->in_order(v);
+	}
+
+	void post_order(Arraylist<Interval<T>>& v) const {
+		if (left)
+			left->post_order(v);
+		if (right)
+			right->post_order(v);
+		v.push_at_back(data);
+	}
+
+	virtual void print(int indent) const {
+		if (right)
+			right->print(indent + 1);
+		for (int i = 0; i < indent; ++i)
+			std::cout << "    ";
+		std::cout << data << " max " << max_end << std::endl;
+		if (left)
+			left->print(indent + 1);
+	}
+
+	Interval<T> data;
+	T max_end;
+	int height{1};
+	IntervalNode* parent{nullptr};
+	IntervalNode* left{nullptr};
+	IntervalNode* right{nullptr};
+};
+
+/* Interval tree: a set of intervals in an AVL tree augmented with the max
+ * high end of every subtree, kept up to date by insert, remove and the
+ * rotations. overlapping() and stabbing() hand the k matching intervals to a
+ * callback as they are found. A query that matches nothing is O(log n); in
+ * general every match can cost a descent of its own through subtrees that
+ * are only pruned further down, so a query is O(min(n, (k + 1) log n)).
+ * param T: data type of the interval ends */
+template <typename T>
+class Intervaltree : public Tree<Interval<T>, IntervalNode<T>> {
+	using Base = Tree<Interval<T>, IntervalNode<T>>;
+	using Node = IntervalNode<T>;
+
+public:
+	Intervaltree() = default;
+
+	Intervaltree(const Intervaltree<T>& other) : Base() {
+		auto list = other.pre_order();
+		for (std::size_t i = 0; i < list.size(); i++) {
+			insert(list[i]);
+		}
+	}
+
+	Intervaltree(Intervaltree<T>&& other) = default;
+
+	Intervaltree<T>& operator=(const Intervaltree<T>& other) {
+		Intervaltree<T> copy{other};
+		std::swap(this->root, copy.root);
+		std::swap(this->size_, copy.size_);
+		return *this;
+	}
+
+	Intervaltree<T>& operator=(Intervaltree<T>&& other) = default;
+
+	/* Inserts 'x', returns false if it is already in the tree */
+	bool insert(const Interval<T>& x) {
+		bool inserted = false;
+		this->root = insert(this->root, x, inserted);
+		this->root->parent = nullptr;
+		this->size_ += inserted;
+		return inserted;
+	}
+
+	bool insert(const T& low, const T& high) { return insert(Interval<T>{low, high}); }
+
+	/* Removes 'x' from the tree, if it exists else return false */
+	bool remove(const Interval<T>& x) {
+		bool removed = false;
+		this->root = remove(this->root, x, removed);
+		if (this->root)
+			this->root->parent = nullptr;
+		this->size_ -= removed;
+		return removed;
+	}
+
+	void clear() {
+		delete this->root;
+		this->root = nullptr;
+		this->size_ = 0;
+	}
+
+	/* Calls f(interval) for every interval overlapping [a, b], in order of
+	   low end. O(min(n, (k + 1) log n)) for k matches */
+	template <typename F>
+	void overlapping(const T& a, const T& b, F f) const {
+		search(this->root, a, b, f);
+	}
+
+	/* Returns the intervals overlapping [a, b], ordered by low end */
+	Arraylist<Interval<T>> overlapping(const T& a, const T& b) const {
+		Arraylist<Interval<T>> out;
+		overlapping(a, b, [&out](const Interval<T>& x) { out.push_at_back(x); });
+		return out;
+	}
+
+	/* Calls f(interval) for every interval containing 'point' */
+	template <typename F>
+	void stabbing(const T& point, F f) const {
+		search(this->root, point, point, f);
+	}
+
+	/* Returns the intervals containing 'point', ordered by low end */
+	Arraylist<Interval<T>> stabbing(const T& point) const {
+		return overlapping(point, point);
+	}
+
+private:
+	/* In order walk of the matches: a subtree is skipped when all of its
+	   intervals end before 'a', and the right subtree when the node (and so
+	   everything after it) starts after 'b' */
+	template <typename F>
+	static void search(const Node* node, const T& a, const T& b, F& f) {
+		while (node && !(node->max_end < a)) {
+			search(node->left, a, b, f);
+			if (b < node->data.low)
+				return;
+			if (!(node->data.high < a))
+				f(node->data);
+			node = node->right;
+		}
+	}
+
+	static int height(const Node* n) { return n ? n->height : 0; }
+
+	/* Recomputes the height and max_end of 'n' from its children */
+	static void update(Node* n) {
+		int l = height(n->left), r = height(n->right);
+		n->height = 1 + (l > r ? l : r);
+		n->max_end = n->data.high;
+		if (n->left && n->max_end < n->left->max_end)
+			n->max_end = n->left->max_end;
+		if (n->right && n->max_end < n->right->max_end)
+			n->max_end = n->right->max_end;
+	}
+
+	static Node* rotate_right(Node* y) {
+		Node* x = y->left;
+		y->left = x->right;
+		if (y->left)
+			y->left->parent = y;
+		x->right = y;
+		x->parent = y->parent;
+		y->parent = x;
+		update(y);
+		update(x);
+		return x;
+	}
+
+	static Node* rotate_left(Node* x) {
+		Node* y = x->right;
+		x->right = y->left;
+		if (x->right)
+			x->right->parent = x;
+		y->left = x;
+		y->parent = x->parent;
+		x->parent = y;
+		update(x);
+		update(y);
+		return y;
+	}
+
+	/* Restores the AVL balance of 'n' after one of its subtrees changed,
+	   returns the new root of the subtree */
+	static Node* balance(Node* n) {
+		update(n);
+		int factor = height(n->left) - height(n->right);
+		if (factor > 1) {
+			if (height(n->left->left) < height(n->left->right))
+				n->left = rotate_left(n->left);
+			return rotate_right(n);
+		}
+		if (factor < -1) {
+			if (height(n->right->right) < height(n->right->left))
+				n->right = rotate_right(n->right);
+			return rotate_left(n);
+		}
+		return n;
+	}
+
+	static Node* insert(Node* n, const Interval<T>& x, bool& inserted) {
+		if (!n) {
+			inserted = true;
+			return new Node(x);
+		}
+		if (x < n->data) {
+			n->left = insert(n->left, x, inserted);
+			n->left->parent = n;
+		} else if (n->data < x) {
+			n->right = insert(n->right, x, inserted);
+			n->right->parent = n;
+		} else {
+			return n;
+		}
+		return inserted ? balance(n) : n;
+	}
+
+	static Node* remove(Node* n, const Interval<T>& x, bool& removed) {
+		if (!n)
+			return nullptr;
+		if (x < n->data) {
+			n->left = remove(n->left, x, removed);
+			if (n->left)
+				n->left->parent = n;
+		} else if (n->data < x) {
+			n->right = remove(n->right, x, removed);
+			if (n->right)
+				n->right->parent = n;
+		} else {
+			removed = true;
+			if (!n->left || !n->right) {
+				Node* child = n->left ? n->left : n->right;
+				n->left = nullptr;
+				n->right = nullptr;
+				delete n;
+				return child;
+			}
+			// Two children: take the place of the smallest interval on the right
+			Node* next = n->right;
+			while (next->left)
+				next = next->left;
+			n->data = next->data;
+			bool ignored = false;
+			n->right = remove(n->right, n->data, ignored);
+			if (n->right)
+				n->right->parent = n;
+		}
+		return removed ? balance(n) : n;
+	}
+};
+
+}
\ No newline at end of file
@@ -3,23 +3,54 @@
 
 namespace structures {
 
-/* Singly linked list, with first pointer: head, with last node points to 'lastnodenull'.*/
+/* Singly linked list, with first pointer: head, with last node points to 'lastnodenull'.
+   A tail pointer is kept as well, so appending to the end (and splicing whole
+   lists onto it) does not walk the list.
+   Inserting functions return a Handle to the new element. A handle stays
+   valid until its element is erased, and insert_after and erase_after
+   through a handle are O(1). */
 template <typename T>
 class Singlelinkedlist {
+	struct Node;
+
 public:
+	/* Stable reference to one element of a list */
+	class Handle {
+	public:
+		Handle() = default;
+
+		T& operator*() const { return node->x; }
+		T* operator->() const { return &node->x; }
+
+		explicit operator bool() const { return node != lastnodenull; }
+		bool operator==(const Handle& other) const { return node == other.node; }
+		bool operator!=(const Handle& other) const { return node != other.node; }
+
+	private:
+		friend class Singlelinkedlist<T>;
+		explicit Handle(Node* node_) : node{node_} {}
+
+		Node* node{lastnodenull};
+	};
+
 	Singlelinkedlist() = default;
 
 	Singlelinkedlist(const Singlelinkedlist<T>& other)
-		: head{copy_list(other.head)}, size_{other.size_} {}
+		: size_{other.size_} {
+		head = copy_list(other.head, tail);
+	}
 
-	Singlelinkedlist(Singlelinkedlist<T>&& other) : head{other.head}, size_{other.size_} {
+	Singlelinkedlist(Singlelinkedlist<T>&& other)
+		: head{other.head}, tail{other.tail}, size_{other.size_} {
 		other.head = lastnodenull;
+		other.tail = lastnodenull;
 		other.size_ = 0;
 	}
 
 	Singlelinkedlist<T>& operator=(const Singlelinkedlist<T>& other) {
 		Singlelinkedlist<T> copy{other};
 		std::swap(head, copy.head);
+		std::swap(tail, copy.tail);
 		std::swap(size_, copy.size_);
 		return *this;
 	}
@@ -27,6 +58,7 @@ public:
 	Singlelinkedlist<T>& operator=(Singlelinkedlist<T>&& other) {
 		Singlelinkedlist<T> copy{std::move(other)};
 		std::swap(head, copy.head);
+		std::swap(tail, copy.tail);
 		std::swap(size_, copy.size_);
 		return *this;
 	}
@@ -40,20 +72,32 @@ public:
 	}
 
 	/* Inserts the element 'x' at the end of the list */
-	void push_back(const T& x) { insert(x, size_); }
+	Handle push_back(const T& x) {
+		if (empty())
+			return push_front(x);
+		tail->next = new Node(x);
+		tail = tail->next;
+		++size_;
+		return Handle{tail};
+	}
 
 	/* Inserts the element 'x' at the beginning of the list */
-	void push_front(const T& x) {
+	Handle push_front(const T& x) {
 		head = new Node(x, head);
+		if (tail == lastnodenull)
+			tail = head;
 		++size_;
+		return Handle{head};
 	}
 
 	/* Inserts an element 'x' at a position 'index' of the list */
-	void insert(const T& x, std::size_t index) {
+	Handle insert(const T& x, std::size_t index) {
 		if (index == 0) {
 			return push_front(x);
 		} else if (index > size_) {
 			throw std::out_of_range("Invalid index");
+		} else if (index == size_) {
+			return push_back(x);
 		} else {
 			Node* it = head;
 			for (std::size_t i = 0; i < index - 1; ++i) {
@@ -62,13 +106,27 @@ public:
 			it->next = new Node(x, it->next);
 
 			++size_;
+			return Handle{it->next};
 		}
 	}
 
+	/* Inserts 'x' right after the element of 'position' */
+	Handle insert_after(Handle position, const T& x) {
+		Node* it = position.node;
+		it->next = new Node(x, it->next);
+		if (it == tail)
+			tail = it->next;
+
+		++size_;
+		return Handle{it->next};
+	}
+
 	/* Inserts an element into sorted list */
-	void insert_sorted(const T& x) {
+	Handle insert_sorted(const T& x) {
 		if (empty() || x <= head->x) {
 			return push_front(x);
+		} else if (x > tail->x) {
+			return push_back(x);
 		} else {
 			Node* it = head;
 			while (it->next != lastnodenull && x > it->next->x) {
@@ -77,6 +135,7 @@ public:
 			it->next = new Node(x, it->next);
 
 			++size_;
+			return Handle{it->next};
 		}
 	}
 
@@ -112,6 +171,8 @@ public:
 			T removed = it->next->x;
 			Node* p_removed = it->next;
 			it->next = it->next->next;
+			if (p_removed == tail)
+				tail = it;
 
 			--size_;
 			delete p_removed;
@@ -119,6 +180,32 @@ public:
 		}
 	}
 
+	/* Return the element removed after the one of 'position' */
+	T erase_after(Handle position) {
+		Node* it = position.node;
+		if (it->next == lastnodenull)
+			throw std::out_of_range("No element after the handle");
+
+		T removed = it->next->x;
+		Node* p_removed = it->next;
+		it->next = p_removed->next;
+		if (p_removed == tail)
+			tail = it;
+
+		--size_;
+		delete p_removed;
+		return removed;
+	}
+
+	/* Removes the element at 'index' if there is one. Returns false instead
+	   of throwing when 'index' is out of bounds */
+	bool try_erase(std::size_t index) {
+		if (index >= size_)
+			return false;
+		erase(index);
+		return true;
+	}
+
 	/* Removes an element at the end of the list and returns it */
 	T pop_back() { return erase(size_ - 1); }
 
@@ -130,29 +217,38 @@ public:
 			T removed = head->x;
 			Node* old_head = head;
 			head = head->next;
+			if (head == lastnodenull)
+				tail = lastnodenull;
 			delete old_head;
 			--size_;
 			return removed;
 		}
 	}
 
-	/* Returns an element 'x' from the list */
-	void remove(const T& x) {
-		if (head->x == x) {
+	/* Removes an element 'x' from the list, returns false if it is not in
+	   the list */
+	bool remove(const T& x) {
+		if (empty()) {
+			return false;
+		} else if (head->x == x) {
 			pop_front();
-			return;
+			return true;
 		} else {
-			Node* it;
-			for (it = head; it->next->x != x; it = it->next) {
-				if (it->next == lastnodenull)
-					return;
+			Node* it = head;
+			while (it->next != lastnodenull && it->next->x != x) {
+				it = it->next;
 			}
+			if (it->next == lastnodenull)
+				return false;
 
 			Node* p_removed = it->next;
 			it->next = it->next->next;
+			if (p_removed == tail)
+				tail = it;
 			delete p_removed;
 
 			--size_;
+			return true;
 		}
 	}
 
@@ -162,7 +258,7 @@ public:
 	/* Returns true if the list contains an element(x) */
 	bool contains(const T& x) const { return find(x) != size_; }
 
-	/* Returns the position of 'x' on the list if it is in the list */
+	/* Returns the position of 'x' on the list, size() if it is not in the list */
 	std::size_t find(const T& x) const {
 		std::size_t index = 0;
 		for (Node* it = head; it != lastnodenull; it = it->next) {
@@ -176,24 +272,65 @@ public:
 	/* Return the size of the list*/
 	std::size_t size() const { return size_; }
 
-	T& front() { return head->x; }
+	/* Handles of the first and the last element, empty if the list is */
+	Handle front_handle() const { return Handle{head}; }
 
-	const T& front() const { return head->x; }
+	Handle back_handle() const { return Handle{tail}; }
+
+	/* Handle of the element after 'position', empty at the end */
+	Handle next(Handle position) const { return Handle{position.node->next}; }
 
-	T& back() {
+	/* Handle of the element at 'index' */
+	Handle handle_at(std::size_t index) const {
+		if (index >= size_)
+			throw std::out_of_range("Index out of bounds");
 		Node* it = head;
-		for (std::size_t i = 1; i < size_; ++i) {
+		for (std::size_t i = 0; i < index; i++) {
 			it = it->next;
 		}
-		return it->x;
+		return Handle{it};
 	}
 
-	const T& back() const {
-		Node* it = head;
-		for (std::size_t i = 1; i < size_; ++i) {
-			it = it->next;
+	T& front() { return head->x; }
+
+	const T& front() const { return head->x; }
+
+	T& back() { return tail->x; }
+
+	const T& back() const { return tail->x; }
+
+	/* Moves every node of 'other' to the end of the list, leaving 'other' empty.
+	   No node is copied or reallocated */
+	void append(Singlelinkedlist<T>&& other) { splice(size_, other); }
+
+	/* Moves every node of 'other' into the list at position 'index', leaving
+	   'other' empty. O(1) at the front or the end, O(index) anywhere else */
+	void splice(std::size_t index, Singlelinkedlist<T>& other) {
+		if (index > size_) {
+			throw std::out_of_range("Invalid index");
+		} else if (other.empty() || &other == this) {
+			return;
+		} else if (index == 0) {
+			other.tail->next = head;
+			head = other.head;
+			if (tail == lastnodenull)
+				tail = other.tail;
+		} else if (index == size_) {
+			tail->next = other.head;
+			tail = other.tail;
+		} else {
+			Node* it = head;
+			for (std::size_t i = 0; i < index - 1; ++i) {
+				it = it->next;
+			}
+			other.tail->next = it->next;
+			it->next = other.head;
 		}
-		return it->x;
+
+		size_ += other.size_;
+		other.head = lastnodenull;
+		other.tail = lastnodenull;
+		other.size_ = 0;
 	}
 
 private:
@@ -205,8 +342,13 @@ private:
 		Node* next{lastnodenull};
 	};
 
-	static Node* copy_list(const Node* other_head) {
-		auto new_tail = new Node(other_head->x);
+	/* Copies the chain starting at 'other_head', storing its last node in 'new_tail' */
+	static Node* copy_list(const Node* other_head, Node*& new_tail) {
+		new_tail = lastnodenull;
+		if (other_head == lastnodenull)
+			return lastnodenull;
+
+		new_tail = new Node(other_head->x);
 		auto new_head = new_tail;
 		auto it = other_head->next;
 
@@ -220,6 +362,7 @@ private:
 	}
 
 	Node* head{lastnodenull};
+	Node* tail{lastnodenull};
 	std::size_t size_{0u};
 };
 
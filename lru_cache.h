@@ -0,0 +1,522 @@
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <array_list.h>
+#include <deque.h>
+#include <hash_functions.h>
+
+namespace structures {
+
+/* Building blocks shared by the caches below */
+namespace cache {
+
+/* Capacity counted in entries */
+struct Unitweight {
+	template <typename K, typename V>
+	std::size_t operator()(const K&, const V&) const {
+		return 1;
+	}
+};
+
+/* Capacity counted in bytes of the key and value objects themselves. For
+   values owning heap memory, pass a weigher that adds it */
+struct Sizeweight {
+	template <typename K, typename V>
+	std::size_t operator()(const K&, const V&) const {
+		return sizeof(K) + sizeof(V);
+	}
+};
+
+/* Hit, miss and eviction counters */
+struct Stats {
+	std::size_t hits{0};
+	std::size_t misses{0};
+	std::size_t evictions{0};
+
+	double hit_rate() const {
+		std::size_t total = hits + misses;
+		return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+	}
+
+	Stats& operator+=(const Stats& other) {
+		hits += other.hits;
+		misses += other.misses;
+		evictions += other.evictions;
+		return *this;
+	}
+};
+
+const std::size_t npos{static_cast<std::size_t>(-1)};
+
+/* Entries kept in an Arraylist and chained into doubly linked lists by
+   position, so linking, unlinking and moving an entry are O(1). Removed
+   entries are recycled through a free list */
+template <typename K, typename V>
+class Entries {
+public:
+	struct Node {
+		K key{};
+		V value{};
+		std::size_t weight{0};
+		std::size_t prev{npos};
+		std::size_t next{npos};
+		unsigned char freq{0};
+		unsigned char queue{0};
+	};
+
+	/* List of entries from 'head' (newest) to 'tail' (oldest) */
+	struct List {
+		std::size_t head{npos};
+		std::size_t tail{npos};
+		std::size_t weight{0};
+		std::size_t size{0};
+	};
+
+	Node& operator[](std::size_t i) { return nodes[i]; }
+
+	std::size_t acquire(const K& key, const V& value, std::size_t weight) {
+		std::size_t i;
+		if (free_list != npos) {
+			i = free_list;
+			free_list = nodes[i].next;
+		} else {
+			i = nodes.size();
+			nodes.push_at_back(Node{});
+		}
+		Node& n = nodes[i];
+		n.key = key;
+		n.value = value;
+		n.weight = weight;
+		n.freq = 0;
+		return i;
+	}
+
+	void release(std::size_t i) {
+		nodes[i] = Node{};
+		nodes[i].next = free_list;
+		free_list = i;
+	}
+
+	void push_front(List& list, std::size_t i) {
+		Node& n = nodes[i];
+		n.prev = npos;
+		n.next = list.head;
+		if (list.head != npos)
+			nodes[list.head].prev = i;
+		else
+			list.tail = i;
+		list.head = i;
+		list.weight += n.weight;
+		list.size++;
+	}
+
+	void unlink(List& list, std::size_t i) {
+		Node& n = nodes[i];
+		if (n.prev != npos)
+			nodes[n.prev].next = n.next;
+		else
+			list.head = n.next;
+		if (n.next != npos)
+			nodes[n.next].prev = n.prev;
+		else
+			list.tail = n.prev;
+		list.weight -= n.weight;
+		list.size--;
+	}
+
+	void clear() {
+		nodes.clear();
+		free_list = npos;
+	}
+
+private:
+	Arraylist<Node> nodes;
+	std::size_t free_list{npos};
+};
+
+}  // namespace cache
+
+/* Least recently used cache: get, put and eviction are O(1).
+ * A hash index maps keys to entries, which are kept in recency order in a
+ * doubly linked list; the least recently used entries are evicted once the
+ * total weight exceeds the capacity.
+ * param K, V: key and value types
+ * param Hash: hash function of the keys
+ * param Weigh: weight of an entry, cache::Unitweight (capacity in entries) or
+ * cache::Sizeweight (capacity in bytes) or any (key, value) -> size_t */
+template <typename K, typename V, typename Hash = std::hash<K>,
+		  typename Weigh = cache::Unitweight>
+class LRUCache {
+public:
+	explicit LRUCache(std::size_t capacity_) : capacity{capacity_} {}
+
+	/* Copies the value of 'key' into 'value' and marks it as most recently
+	   used. Returns false on a miss */
+	bool get(const K& key, V& value) {
+		auto it = index.find(key);
+		if (it == index.end()) {
+			stats_.misses++;
+			return false;
+		}
+		stats_.hits++;
+		entries.unlink(order, it->second);
+		entries.push_front(order, it->second);
+		value = entries[it->second].value;
+		return true;
+	}
+
+	/* Stores 'value' under 'key' as most recently used entry, evicting the
+	   least recently used ones as needed. An entry heavier than the whole
+	   capacity is not stored */
+	void put(const K& key, const V& value) {
+		std::size_t weight = weigh(key, value);
+		auto it = index.find(key);
+		if (it != index.end()) {
+			entries.unlink(order, it->second);
+			if (weight > capacity) {
+				entries.release(it->second);
+				index.erase(it);
+				return;
+			}
+			entries[it->second].value = value;
+			entries[it->second].weight = weight;
+			entries.push_front(order, it->second);
+		} else {
+			if (weight > capacity)
+				return;
+			std::size_t i = entries.acquire(key, value, weight);
+			entries.push_front(order, i);
+			index.emplace(key, i);
+		}
+		while (order.weight > capacity)
+			evict();
+	}
+
+	/* Removes 'key', returns false if it was not cached */
+	bool erase(const K& key) {
+		auto it = index.find(key);
+		if (it == index.end())
+			return false;
+		entries.unlink(order, it->second);
+		entries.release(it->second);
+		index.erase(it);
+		return true;
+	}
+
+	/* Returns true if 'key' is cached, without touching its recency */
+	bool contains(const K& key) const { return index.count(key) != 0; }
+
+	void clear() {
+		index.clear();
+		entries.clear();
+		order = {};
+	}
+
+	std::size_t size() const { return order.size; }
+
+	/* Total weight of the cached entries */
+	std::size_t weight() const { return order.weight; }
+
+	const cache::Stats& stats() const { return stats_; }
+
+private:
+	void evict() {
+		std::size_t i = order.tail;
+		index.erase(entries[i].key);
+		entries.unlink(order, i);
+		entries.release(i);
+		stats_.evictions++;
+	}
+
+	std::size_t capacity;
+	// Key to entry position. Hashtablewrapper is a set with no map interface:
+	// keying it with (key, position) records would build a probe record, key
+	// copy included, on every lookup
+	std::unordered_map<K, std::size_t, Hash> index;
+	cache::Entries<K, V> entries;
+	typename cache::Entries<K, V>::List order;
+	cache::Stats stats_;
+	Weigh weigh{};
+};
+
+/* S3-FIFO cache (Yang et al., SOSP 2023): three FIFO queues instead of a
+ * recency list, so a hit only bumps a small counter and never relinks.
+ * New keys enter a small queue (a tenth of the capacity); on eviction from
+ * it, keys that were hit since insertion move to the main queue and the
+ * others leave, remembered by hash in a ghost queue. A key found in the ghost
+ * queue goes straight to the main queue. The main queue evicts like CLOCK:
+ * entries with a nonzero counter are reinserted with the counter decreased.
+ * This filters out one-hit wonders and usually beats LRU's hit rate on skewed
+ * workloads. Same parameters and interface as LRUCache */
+template <typename K, typename V, typename Hash = std::hash<K>,
+		  typename Weigh = cache::Unitweight>
+class S3FIFOCache {
+public:
+	explicit S3FIFOCache(std::size_t capacity_)
+		: capacity{capacity_}, small_capacity{capacity_ / 10 > 0 ? capacity_ / 10 : 1} {}
+
+	/* Copies the value of 'key' into 'value'. Returns false on a miss */
+	bool get(const K& key, V& value) {
+		auto it = index.find(key);
+		if (it == index.end()) {
+			stats_.misses++;
+			return false;
+		}
+		stats_.hits++;
+		auto& n = entries[it->second];
+		if (n.freq < max_freq)
+			n.freq++;
+		value = n.value;
+		return true;
+	}
+
+	/* Stores 'value' under 'key', evicting entries as needed. An entry
+	   heavier than the whole capacity is not stored */
+	void put(const K& key, const V& value) {
+		std::size_t weight = weigh(key, value);
+		auto it = index.find(key);
+		if (it != index.end()) {
+			std::size_t i = it->second;
+			auto& queue = entries[i].queue == main_queue ? main : small;
+			entries.unlink(queue, i);
+			if (weight > capacity) {
+				entries.release(i);
+				index.erase(it);
+				return;
+			}
+			entries[i].value = value;
+			entries[i].weight = weight;
+			entries.push_front(queue, i);
+		} else {
+			if (weight > capacity)
+				return;
+			std::size_t i = entries.acquire(key, value, weight);
+			if (forget(hashf(key))) {
+				entries[i].queue = main_queue;
+				entries.push_front(main, i);
+			} else {
+				entries[i].queue = small_queue;
+				entries.push_front(small, i);
+			}
+			index.emplace(key, i);
+		}
+		while (small.weight + main.weight > capacity)
+			evict();
+	}
+
+	/* Removes 'key', returns false if it was not cached */
+	bool erase(const K& key) {
+		auto it = index.find(key);
+		if (it == index.end())
+			return false;
+		std::size_t i = it->second;
+		entries.unlink(entries[i].queue == main_queue ? main : small, i);
+		entries.release(i);
+		index.erase(it);
+		return true;
+	}
+
+	/* Returns true if 'key' is cached, without counting an access */
+	bool contains(const K& key) const { return index.count(key) != 0; }
+
+	void clear() {
+		index.clear();
+		entries.clear();
+		small = {};
+		main = {};
+		ghost.clear();
+		ghost_order.clear();
+	}
+
+	std::size_t size() const { return small.size + main.size; }
+
+	/* Total weight of the cached entries */
+	std::size_t weight() const { return small.weight + main.weight; }
+
+	const cache::Stats& stats() const { return stats_; }
+
+private:
+	const static unsigned char max_freq{3};
+	const static unsigned char small_queue{0};
+	const static unsigned char main_queue{1};
+
+	void evict() {
+		if (small.weight > small_capacity || main.size == 0)
+			evict_small();
+		else
+			evict_main();
+	}
+
+	/* The oldest entry of the small queue moves to the main queue if it was
+	   hit, otherwise it is evicted into the ghost queue */
+	void evict_small() {
+		std::size_t i = small.tail;
+		entries.unlink(small, i);
+		auto& n = entries[i];
+		if (n.freq > 0) {
+			n.freq = 0;
+			n.queue = main_queue;
+			entries.push_front(main, i);
+			return;
+		}
+		remember(hashf(n.key));
+		drop(i);
+	}
+
+	/* The oldest entry of the main queue is reinserted while its counter
+	   is nonzero, otherwise evicted */
+	void evict_main() {
+		while (true) {
+			std::size_t i = main.tail;
+			entries.unlink(main, i);
+			auto& n = entries[i];
+			if (n.freq > 0) {
+				n.freq--;
+				entries.push_front(main, i);
+				continue;
+			}
+			drop(i);
+			return;
+		}
+	}
+
+	void drop(std::size_t i) {
+		index.erase(entries[i].key);
+		entries.release(i);
+		stats_.evictions++;
+	}
+
+	/* The ghost queue remembers about as many key hashes as there are cached
+	   entries. 'ghost' maps a hash to the sequence number of its latest
+	   insertion, so older positions of the same hash in 'ghost_order' are
+	   recognised as stale when they expire */
+	void remember(std::size_t h) {
+		ghost[h] = ++ghost_sequence;
+		ghost_order.push_at_back({h, ghost_sequence});
+		while (ghost_order.size() > size() + 1) {
+			auto oldest = ghost_order.pop_at_front();
+			auto it = ghost.find(oldest.first);
+			if (it != ghost.end() && it->second == oldest.second)
+				ghost.erase(it);
+		}
+	}
+
+	/* Removes 'h' from the ghost queue, returns false if it was not there */
+	bool forget(std::size_t h) { return ghost.erase(h) != 0; }
+
+	std::size_t capacity;
+	std::size_t small_capacity;
+	std::unordered_map<K, std::size_t, Hash> index;
+	cache::Entries<K, V> entries;
+	typename cache::Entries<K, V>::List small;
+	typename cache::Entries<K, V>::List main;
+	std::unordered_map<std::size_t, std::uint64_t> ghost;
+	Deque<std::pair<std::size_t, std::uint64_t>> ghost_order;
+	std::uint64_t ghost_sequence{0};
+	cache::Stats stats_;
+	Hash hashf{};
+	Weigh weigh{};
+};
+
+/* Thread safe cache split into 'shards' independently locked caches, picked
+ * by key hash, so threads working on different keys rarely contend. The
+ * capacity is split as evenly as possible, so the shards add up to exactly
+ * 'capacity'; with a capacity below the shard count, there is one shard per
+ * unit of capacity.
+ * param Cache: the cache type of a shard, LRUCache<K, V> or S3FIFOCache<K, V> */
+template <typename K, typename V, typename Cache = LRUCache<K, V>,
+		  typename Hash = std::hash<K>>
+class ShardedCache {
+public:
+	explicit ShardedCache(std::size_t capacity, std::size_t shards = 16)
+		: count{shards < capacity ? shards : capacity}, parts{nullptr} {
+		if (count == 0)
+			count = 1;
+		parts.reset(new Shard[count]);
+		for (std::size_t i = 0; i < count; ++i)
+			parts[i].cache = Cache{capacity / count + (i < capacity % count ? 1 : 0)};
+	}
+
+	ShardedCache(const ShardedCache&) = delete;
+	ShardedCache& operator=(const ShardedCache&) = delete;
+
+	bool get(const K& key, V& value) {
+		Shard& s = shard(key);
+		std::lock_guard<std::mutex> lock{s.mutex};
+		return s.cache.get(key, value);
+	}
+
+	void put(const K& key, const V& value) {
+		Shard& s = shard(key);
+		std::lock_guard<std::mutex> lock{s.mutex};
+		s.cache.put(key, value);
+	}
+
+	bool erase(const K& key) {
+		Shard& s = shard(key);
+		std::lock_guard<std::mutex> lock{s.mutex};
+		return s.cache.erase(key);
+	}
+
+	bool contains(const K& key) const {
+		Shard& s = shard(key);
+		std::lock_guard<std::mutex> lock{s.mutex};
+		return s.cache.contains(key);
+	}
+
+	void clear() {
+		for (std::size_t i = 0; i < count; ++i) {
+			std::lock_guard<std::mutex> lock{parts[i].mutex};
+			parts[i].cache.clear();
+		}
+	}
+
+	/* Sums over the shards; exact only when no update is running */
+	std::size_t size() const {
+		std::size_t n = 0;
+		for (std::size_t i = 0; i < count; ++i) {
+			std::lock_guard<std::mutex> lock{parts[i].mutex};
+			n += parts[i].cache.size();
+		}
+		return n;
+	}
+
+	cache::Stats stats() const {
+		cache::Stats total;
+		for (std::size_t i = 0; i < count; ++i) {
+			std::lock_guard<std::mutex> lock{parts[i].mutex};
+			total += parts[i].cache.stats();
+		}
+		return total;
+	}
+
+private:
+	struct Shard {
+		mutable std::mutex mutex;
+		Cache cache{0};
+		// Keeps the locks of neighbouring shards off each other's cache line
+		char padding[64];
+	};
+
+	Shard& shard(const K& key) const {
+		// Mixed again so that identity hashes still spread over the shards
+		std::uint64_t h = hashing::mix(hashf(key));
+		return parts[static_cast<std::size_t>(((h >> 32) * count) >> 32)];
+	}
+
+	std::size_t count;
+	std::unique_ptr<Shard[]> parts;
+	Hash hashf{};
+};
+
+template <typename K, typename V, typename Hash, typename Weigh>
+const unsigned char S3FIFOCache<K, V, Hash, Weigh>::max_freq;
+template <typename K, typename V, typename Hash, typename Weigh>
+const unsigned char S3FIFOCache<K, V, Hash, Weigh>::small_queue;
+template <typename K, typename V, typename Hash, typename Weigh>
+const unsigned char S3FIFOCache<K, V, Hash, Weigh>::main_queue;
+
+}
\ No newline at end of file
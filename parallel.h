@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread_pool.h>
+
+namespace structures {
+
+/* Parallel algorithms working in place on the contiguous storage of an
+ * Arraylist (or any list with size() and contiguous operator[]), run on a
+ * Threadpool. Ranges are cut into chunks of at least 'grain' elements, one
+ * task per chunk; idle workers steal chunks from busy ones. */
+namespace parallel {
+
+const std::size_t default_grain{4096};
+
+/* Number of chunks of at least 'grain' elements for 'n' elements */
+inline std::size_t chunks(std::size_t n, std::size_t grain) {
+	if (grain == 0)
+		grain = 1;
+	std::size_t c = (n + grain - 1) / grain;
+	return c > 0 ? c : 1;
+}
+
+/* Runs f(k, lo, hi) for each chunk k of the 'c' chunks of [0, n) */
+template <typename F>
+void for_chunks(std::size_t n, std::size_t c, Threadpool& pool, F f) {
+	if (c == 1) {
+		f(0, 0, n);
+		return;
+	}
+	Taskgroup group{pool};
+	for (std::size_t k = 0; k < c; ++k) {
+		std::size_t lo = n * k / c, hi = n * (k + 1) / c;
+		group.run([&f, k, lo, hi] { f(k, lo, hi); });
+	}
+	group.wait();
+}
+
+}  // namespace parallel
+
+/* Calls f(x) on every element of 'list' */
+template <typename List, typename F>
+void parallel_for_each(List& list, F f,
+					   std::size_t grain = parallel::default_grain,
+					   Threadpool& pool = Threadpool::global()) {
+	std::size_t n = list.size();
+	if (n == 0)
+		return;
+	auto data = &list[0];
+	std::size_t c = parallel::chunks(n, grain);
+	if (c == 1) {
+		for (std::size_t i = 0; i < n; ++i)
+			f(data[i]);
+		return;
+	}
+	parallel::for_chunks(n, c, pool, [&](std::size_t, std::size_t lo, std::size_t hi) {
+		for (std::size_t i = lo; i < hi; ++i)
+			f(data[i]);
+	});
+}
+
+/* Folds the elements of 'list' into 'init' with 'op', which must be
+   associative; chunks are folded in parallel and then combined in order */
+template <typename List, typename T, typename Op = std::plus<T>>
+T parallel_reduce(const List& list, T init, Op op = Op{},
+				  std::size_t grain = parallel::default_grain,
+				  Threadpool& pool = Threadpool::global()) {
+	std::size_t n = list.size();
+	if (n == 0)
+		return init;
+	auto data = &list[0];
+	std::size_t c = parallel::chunks(n, grain);
+	if (c == 1) {
+		for (std::size_t i = 0; i < n; ++i)
+			init = op(init, data[i]);
+		return init;
+	}
+	std::unique_ptr<T[]> partial{new T[c]};
+	parallel::for_chunks(n, c, pool, [&](std::size_t k, std::size_t lo, std::size_t hi) {
+		T acc = data[lo];
+		for (std::size_t i = lo + 1; i < hi; ++i)
+			acc = op(acc, data[i]);
+		partial[k] = acc;
+	});
+	for (std::size_t k = 0; k < c; ++k)
+		init = op(init, partial[k]);
+	return init;
+}
+
+namespace parallel {
+
+/* Two pass scan: chunk totals in parallel, a sequential scan over the
+   totals, then every chunk is scanned from its offset in parallel */
+template <typename List, typename T, typename Op>
+void scan(List& list, T init, Op op, bool inclusive, std::size_t grain,
+		  Threadpool& pool) {
+	std::size_t n = list.size();
+	if (n == 0)
+		return;
+	auto data = &list[0];
+
+	std::size_t c = chunks(n, grain);
+	std::unique_ptr<T[]> offset{new T[c]};
+	if (c > 1) {
+		std::unique_ptr<T[]> total{new T[c]};
+		for_chunks(n, c, pool, [&](std::size_t k, std::size_t lo, std::size_t hi) {
+			T acc = data[lo];
+			for (std::size_t i = lo + 1; i < hi; ++i)
+				acc = op(acc, data[i]);
+			total[k] = acc;
+		});
+		offset[0] = init;
+		for (std::size_t k = 1; k < c; ++k)
+			offset[k] = op(offset[k - 1], total[k - 1]);
+	} else {
+		offset[0] = init;
+	}
+
+	auto apply = [&](std::size_t k, std::size_t lo, std::size_t hi) {
+		T acc = offset[k];
+		for (std::size_t i = lo; i < hi; ++i) {
+			T x = data[i];
+			if (inclusive) {
+				acc = op(acc, x);
+				data[i] = acc;
+			} else {
+				data[i] = acc;
+				acc = op(acc, x);
+			}
+		}
+	};
+	for_chunks(n, c, pool, apply);
+}
+
+}  // namespace parallel
+
+/* Replaces every element by op(init, x0, ..., xi), in place */
+template <typename List, typename T, typename Op = std::plus<T>>
+void parallel_inclusive_scan(List& list, T init, Op op = Op{},
+							 std::size_t grain = parallel::default_grain,
+							 Threadpool& pool = Threadpool::global()) {
+	parallel::scan(list, init, op, true, grain, pool);
+}
+
+/* Replaces every element by op(init, x0, ..., xi-1), in place */
+template <typename List, typename T, typename Op = std::plus<T>>
+void parallel_exclusive_scan(List& list, T init, Op op = Op{},
+							 std::size_t grain = parallel::default_grain,
+							 Threadpool& pool = Threadpool::global()) {
+	parallel::scan(list, init, op, false, grain, pool);
+}
+
+/* Moves the elements for which 'pred' holds before the others, keeping the
+   relative order within both groups. Returns the number of elements for
+   which 'pred' holds */
+template <typename List, typename Pred>
+std::size_t parallel_partition(List& list, Pred pred,
+							   std::size_t grain = parallel::default_grain,
+							   Threadpool& pool = Threadpool::global()) {
+	using T = typename std::remove_reference<decltype(list[0])>::type;
+	std::size_t n = list.size();
+	if (n == 0)
+		return 0;
+	auto data = &list[0];
+	std::size_t c = parallel::chunks(n, grain);
+
+	// Count the matches of every chunk, then give each chunk its output slots
+	std::unique_ptr<std::size_t[]> hits{new std::size_t[c]};
+	parallel::for_chunks(n, c, pool, [&](std::size_t k, std::size_t lo, std::size_t hi) {
+		std::size_t h = 0;
+		for (std::size_t i = lo; i < hi; ++i)
+			h += pred(data[i]) ? 1 : 0;
+		hits[k] = h;
+	});
+	std::unique_ptr<std::size_t[]> first{new std::size_t[c]};
+	std::size_t total = 0;
+	for (std::size_t k = 0; k < c; ++k) {
+		first[k] = total;
+		total += hits[k];
+	}
+
+	std::unique_ptr<T[]> out{new T[n]};
+	parallel::for_chunks(n, c, pool, [&](std::size_t k, std::size_t lo, std::size_t hi) {
+		std::size_t yes = first[k];
+		std::size_t no = total + (lo - first[k]);
+		for (std::size_t i = lo; i < hi; ++i) {
+			if (pred(data[i]))
+				out[yes++] = std::move(data[i]);
+			else
+				out[no++] = std::move(data[i]);
+		}
+	});
+	parallel::for_chunks(n, c, pool, [&](std::size_t, std::size_t lo, std::size_t hi) {
+		std::move(out.get() + lo, out.get() + hi, data + lo);
+	});
+	return total;
+}
+
+/* Sorts 'list' with 'comp': chunks are sorted in parallel and then merged
+   pairwise, each round of merges in parallel */
+template <typename List, typename Compare = std::less<
+							 typename std::remove_reference<decltype(
+								 std::declval<List&>()[0])>::type>>
+void parallel_sort(List& list, Compare comp = Compare{},
+				   std::size_t grain = parallel::default_grain,
+				   Threadpool& pool = Threadpool::global()) {
+	using T = typename std::remove_reference<decltype(list[0])>::type;
+	std::size_t n = list.size();
+	if (n < 2)
+		return;
+	T* data = &list[0];
+	std::size_t c = parallel::chunks(n, grain);
+	if (c == 1) {
+		std::sort(data, data + n, comp);
+		return;
+	}
+
+	std::unique_ptr<std::size_t[]> bound{new std::size_t[c + 1]};
+	for (std::size_t k = 0; k <= c; ++k)
+		bound[k] = n * k / c;
+	parallel::for_chunks(n, c, pool, [&](std::size_t, std::size_t lo, std::size_t hi) {
+		std::sort(data + lo, data + hi, comp);
+	});
+
+	// Merge runs of 'width' chunks pairwise, alternating between the two buffers
+	std::unique_ptr<T[]> buffer{new T[n]};
+	T* from = data;
+	T* to = buffer.get();
+	for (std::size_t width = 1; width < c; width *= 2) {
+		Taskgroup group{pool};
+		for (std::size_t k = 0; k < c; k += 2 * width) {
+			std::size_t lo = bound[k];
+			std::size_t mid = bound[std::min(k + width, c)];
+			std::size_t hi = bound[std::min(k + 2 * width, c)];
+			group.run([=, &comp] {
+				std::merge(std::make_move_iterator(from + lo),
+						   std::make_move_iterator(from + mid),
+						   std::make_move_iterator(from + mid),
+						   std::make_move_iterator(from + hi), to + lo, comp);
+			});
+		}
+		group.wait();
+		std::swap(from, to);
+	}
+	if (from != data)
+		std::move(from, from + n, data);
+}
+
+}
\ No newline at end of file
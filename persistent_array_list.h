@@ -0,0 +1,208 @@
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace structures {
+
+/* Persistent (immutable) list, stored as a 32-way trie of fixed size leaves
+ * plus a separate tail leaf (as in Clojure's PersistentVector).
+ * push_at_back(), set() and pop_at_back() return a new version that copies
+ * O(log32 n) nodes and shares everything else with the old one, so copying a
+ * Persistentarraylist (taking a snapshot) is O(1) and never blocks updates.
+ * param T: data type of the elements */
+template <typename T>
+class Persistentarraylist {
+	const static unsigned bits{5};
+	const static std::size_t width{std::size_t{1} << bits};
+	const static std::size_t mask{width - 1};
+
+public:
+	Persistentarraylist() = default;
+
+	/* Returns a version with 'data' added at the end */
+	Persistentarraylist<T> push_at_back(const T& data) const {
+		Persistentarraylist<T> out{*this};
+		std::size_t in_tail = size_ - tail_offset();
+		if (in_tail < width) {
+			auto leaf = tail ? std::make_shared<Leaf>(*tail)
+							 : std::make_shared<Leaf>();
+			leaf->items[in_tail] = data;
+			out.tail = std::move(leaf);
+		} else {
+			// The tail is full: move it into the trie and start a new one
+			if ((size_ >> bits) > (std::size_t{1} << shift)) {
+				auto new_root = std::make_shared<Branch>();
+				new_root->children[0] = root;
+				new_root->children[1] = new_path(shift, tail);
+				out.root = std::move(new_root);
+				out.shift = shift + bits;
+			} else {
+				out.root = push_tail(shift, root.get(), tail);
+			}
+			auto leaf = std::make_shared<Leaf>();
+			leaf->items[0] = data;
+			out.tail = std::move(leaf);
+		}
+		++out.size_;
+		return out;
+	}
+
+	/* Returns a version with the element at position 'index' replaced by
+	   'data' */
+	Persistentarraylist<T> set(std::size_t index, const T& data) const {
+		if (index >= size_)
+			throw std::out_of_range("Index out of bounds");
+		Persistentarraylist<T> out{*this};
+		if (index >= tail_offset()) {
+			auto leaf = std::make_shared<Leaf>(*tail);
+			leaf->items[index & mask] = data;
+			out.tail = std::move(leaf);
+		} else {
+			out.root = assoc(shift, root.get(), index, data);
+		}
+		return out;
+	}
+
+	/* Returns a version without the element at the end of the list */
+	Persistentarraylist<T> pop_at_back() const {
+		if (empty())
+			throw std::out_of_range("List is empty");
+		if (size_ == 1)
+			return Persistentarraylist<T>{};
+
+		Persistentarraylist<T> out{*this};
+		--out.size_;
+		if (size_ - tail_offset() > 1)
+			return out;  // the shared tail just holds one stale element
+
+		// The tail becomes empty: the last leaf of the trie becomes the tail
+		out.tail = std::static_pointer_cast<const Leaf>(leaf_for(size_ - 2));
+		auto new_root = pop_tail(shift, root.get());
+		out.root = new_root ? new_root : std::make_shared<Branch>();
+		if (shift > bits && !branch(out.root.get())->children[1]) {
+			out.root = branch(out.root.get())->children[0];
+			out.shift = shift - bits;
+		}
+		return out;
+	}
+
+	/* Return True if list is empty */
+	bool empty() const { return size_ == 0; }
+
+	/* Return the list's size */
+	std::size_t size() const { return size_; }
+
+	/* Check for the 'index' that it is valid in the list and then return the
+	   reference to the element at the given index position */
+	const T& at(std::size_t index) const {
+		if (index >= size_)
+			throw std::out_of_range("Index out of bounds");
+		return operator[](index);
+	}
+
+	const T& operator[](std::size_t index) const {
+		if (index >= tail_offset())
+			return tail->items[index & mask];
+		return static_cast<const Leaf*>(leaf_for(index).get())
+			->items[index & mask];
+	}
+
+	const T& front() const { return operator[](0); }
+
+	const T& back() const { return operator[](size_ - 1); }
+
+private:
+	struct Node {
+		virtual ~Node() = default;
+	};
+
+	using Link = std::shared_ptr<const Node>;
+
+	struct Branch : Node {
+		Link children[width];
+	};
+
+	struct Leaf : Node {
+		T items[width]{};
+	};
+
+	static const Branch* branch(const Node* n) {
+		return static_cast<const Branch*>(n);
+	}
+
+	/* Index of the first element stored in the tail */
+	std::size_t tail_offset() const {
+		return size_ < width ? 0 : ((size_ - 1) >> bits) << bits;
+	}
+
+	/* Returns the trie leaf that holds position 'index' */
+	Link leaf_for(std::size_t index) const {
+		const Link* node = &root;
+		for (unsigned level = shift; level > 0; level -= bits) {
+			node = &branch(node->get())->children[(index >> level) & mask];
+		}
+		return *node;
+	}
+
+	/* Builds a chain of single child branches 'level' deep ending in 'node' */
+	static Link new_path(unsigned level, Link node) {
+		if (level == 0)
+			return node;
+		auto b = std::make_shared<Branch>();
+		b->children[0] = new_path(level - bits, std::move(node));
+		return b;
+	}
+
+	Link push_tail(unsigned level, const Node* parent, Link tail_leaf) const {
+		auto copy = std::make_shared<Branch>(*branch(parent));
+		std::size_t sub = ((size_ - 1) >> level) & mask;
+		if (level == bits) {
+			copy->children[sub] = std::move(tail_leaf);
+		} else if (copy->children[sub]) {
+			copy->children[sub] = push_tail(
+				level - bits, copy->children[sub].get(), std::move(tail_leaf));
+		} else {
+			copy->children[sub] = new_path(level - bits, std::move(tail_leaf));
+		}
+		return copy;
+	}
+
+	Link pop_tail(unsigned level, const Node* node) const {
+		std::size_t sub = ((size_ - 2) >> level) & mask;
+		if (level > bits) {
+			Link child = pop_tail(level - bits, branch(node)->children[sub].get());
+			if (!child && sub == 0)
+				return nullptr;
+			auto copy = std::make_shared<Branch>(*branch(node));
+			copy->children[sub] = std::move(child);
+			return copy;
+		} else if (sub == 0) {
+			return nullptr;
+		} else {
+			auto copy = std::make_shared<Branch>(*branch(node));
+			copy->children[sub] = nullptr;
+			return copy;
+		}
+	}
+
+	static Link assoc(unsigned level, const Node* node, std::size_t index,
+					  const T& data) {
+		if (level == 0) {
+			auto leaf = std::make_shared<Leaf>(*static_cast<const Leaf*>(node));
+			leaf->items[index & mask] = data;
+			return leaf;
+		}
+		auto copy = std::make_shared<Branch>(*branch(node));
+		std::size_t sub = (index >> level) & mask;
+		copy->children[sub] =
+			assoc(level - bits, copy->children[sub].get(), index, data);
+		return copy;
+	}
+
+	Link root = std::make_shared<const Branch>();
+	std::shared_ptr<const Leaf> tail;
+	unsigned shift{bits};
+	std::size_t size_{0u};
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <memory>
+#include <array_list.h>
+
+namespace structures {
+
+/* Persistent (immutable) balanced binary search tree.
+ * insert() and remove() never modify the tree they are called on: they return
+ * a new version that copies only the O(log n) nodes on the changed path (AVL
+ * balanced) and shares every other node with the old version. Copying a
+ * Persistenttree is O(1), so taking a snapshot is just a copy, and readers of
+ * a snapshot are never affected by later updates.
+ * Nodes are reference counted, so versions may be handed to other threads;
+ * publishing a new version to a shared variable still needs the usual
+ * synchronisation (e.g. std::atomic_store on a std::shared_ptr).
+ * param T: data type of the elements */
+template <typename T>
+class Persistenttree {
+public:
+	Persistenttree() = default;
+
+	/* Returns a version of the tree that contains 'x' */
+	Persistenttree<T> insert(const T& x) const {
+		bool inserted = true;
+		Link new_root = insert(root, x, inserted);
+		return inserted ? Persistenttree<T>{new_root, size_ + 1} : *this;
+	}
+
+	/* Returns a version of the tree without 'x' */
+	Persistenttree<T> remove(const T& x) const {
+		bool removed = false;
+		Link new_root = remove(root, x, removed);
+		return removed ? Persistenttree<T>{new_root, size_ - 1} : *this;
+	}
+
+	/* Returns true if the tree contains 'x' */
+	bool contains(const T& x) const {
+		const Node* it = root.get();
+		while (it) {
+			if (x < it->x)
+				it = it->left.get();
+			else if (it->x < x)
+				it = it->right.get();
+			else
+				return true;
+		}
+		return false;
+	}
+
+	bool empty() const { return size_ == 0; }
+
+	/* Returns the size of the tree */
+	std::size_t size() const { return size_; }
+
+	/* Returns a in-ordered list of the tree */
+	Arraylist<T> in_order() const {
+		Arraylist<T> out{size_ + 1};
+		in_order(root.get(), out);
+		return out;
+	}
+
+private:
+	struct Node;
+	using Link = std::shared_ptr<const Node>;
+
+	struct Node {
+		Node(const T& x_, Link left_, Link right_)
+			: x{x_}
+			, left{std::move(left_)}
+			, right{std::move(right_)}
+			, height{1 + std::max(height_of(left), height_of(right))} {}
+
+		T x;
+		Link left;
+		Link right;
+		int height;
+	};
+
+	Persistenttree(Link root_, std::size_t count)
+		: root{std::move(root_)}, size_{count} {}
+
+	static int height_of(const Link& n) { return n ? n->height : 0; }
+
+	static Link make(const T& x, Link left, Link right) {
+		return std::make_shared<const Node>(x, std::move(left), std::move(right));
+	}
+
+	/* Builds the node (x, left, right), rotating if the heights of the two
+	   subtrees differ by two */
+	static Link balance(const T& x, Link left, Link right) {
+		int hl = height_of(left), hr = height_of(right);
+		if (hl > hr + 1) {
+			if (height_of(left->left) >= height_of(left->right)) {
+				return make(left->x, left->left, make(x, left->right, right));
+			} else {
+				const Link& lr = left->right;
+				return make(lr->x, make(left->x, left->left, lr->left),
+							make(x, lr->right, right));
+			}
+		} else if (hr > hl + 1) {
+			if (height_of(right->right) >= height_of(right->left)) {
+				return make(right->x, make(x, left, right->left), right->right);
+			} else {
+				const Link& rl = right->left;
+				return make(rl->x, make(x, left, rl->left),
+							make(right->x, rl->right, right->right));
+			}
+		}
+		return make(x, std::move(left), std::move(right));
+	}
+
+	static Link insert(const Link& n, const T& x, bool& inserted) {
+		if (!n)
+			return make(x, nullptr, nullptr);
+		if (x < n->x) {
+			Link left = insert(n->left, x, inserted);
+			return inserted ? balance(n->x, left, n->right) : n;
+		} else if (n->x < x) {
+			Link right = insert(n->right, x, inserted);
+			return inserted ? balance(n->x, n->left, right) : n;
+		} else {
+			inserted = false;
+			return n;
+		}
+	}
+
+	static Link remove(const Link& n, const T& x, bool& removed) {
+		if (!n)
+			return n;
+		if (x < n->x) {
+			Link left = remove(n->left, x, removed);
+			return removed ? balance(n->x, left, n->right) : n;
+		} else if (n->x < x) {
+			Link right = remove(n->right, x, removed);
+			return removed ? balance(n->x, n->left, right) : n;
+		} else {
+			removed = true;
+			if (!n->left)
+				return n->right;
+			if (!n->right)
+				return n->left;
+			const Node* it = n->right.get();
+			while (it->left)
+				it = it->left.get();
+			return balance(it->x, n->left, remove_min(n->right));
+		}
+	}
+
+	static Link remove_min(const Link& n) {
+		if (!n->left)
+			return n->right;
+		return balance(n->x, remove_min(n->left), n->right);
+	}
+
+	static void in_order(const Node* n, Arraylist<T>& v) {
+		if (!n)
+			return;
+		in_order(n->left.get(), v);
+		v.push_at_back(n->x);
+		in_order(n->right.get(), v);
+	}
+
+	Link root;
+	std::size_t size_{0u};
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <array_list.h>
+
+namespace structures {
+
+/* D-ary heap on an Arraylist. As with std::priority_queue, top() is the
+ * largest element according to 'Compare' (std::greater gives a min-heap).
+ * params T: data type of the elements
+ * param Compare: strict weak ordering of the elements
+ * param D: number of children per node, 2 for a binary heap. Wider heaps are
+ * shallower, which makes push cheaper and pop more expensive */
+template <typename T, typename Compare = std::less<T>, std::size_t D = 2>
+class PriorityQueue {
+	static_assert(D >= 2, "A heap node needs at least two children");
+
+public:
+	PriorityQueue() = default;
+
+	/* Builds the heap from [first, last) in O(n) */
+	template <typename It>
+	PriorityQueue(It first, It last) {
+		for (; first != last; ++first)
+			heap.push_at_back(*first);
+		heapify();
+	}
+
+	explicit PriorityQueue(const Arraylist<T>& list) : heap{list} { heapify(); }
+
+	/* Inserts 'x' */
+	void push(const T& x) {
+		heap.push_at_back(x);
+		sift_up(heap.size() - 1);
+	}
+
+	/* Removes the top element and returns it */
+	T pop() {
+		if (empty())
+			throw std::out_of_range("Priority queue is empty");
+		T out = heap.front();
+		T last = heap.pop_at_back();
+		if (!empty()) {
+			heap[0] = last;
+			sift_down(0);
+		}
+		return out;
+	}
+
+	const T& top() const { return heap.front(); }
+
+	void clear() { heap.clear(); }
+
+	bool empty() const { return heap.empty(); }
+
+	std::size_t size() const { return heap.size(); }
+
+private:
+	void heapify() {
+		if (heap.size() < 2)
+			return;
+		for (std::size_t i = (heap.size() - 2) / D + 1; i-- > 0;)
+			sift_down(i);
+	}
+
+	void sift_up(std::size_t i) {
+		T x = heap[i];
+		while (i > 0) {
+			std::size_t parent = (i - 1) / D;
+			if (!less(heap[parent], x))
+				break;
+			heap[i] = heap[parent];
+			i = parent;
+		}
+		heap[i] = x;
+	}
+
+	void sift_down(std::size_t i) {
+		T x = heap[i];
+		std::size_t n = heap.size();
+		while (true) {
+			std::size_t first = D * i + 1;
+			if (first >= n)
+				break;
+			std::size_t last = first + D < n ? first + D : n;
+			std::size_t best = first;
+			for (std::size_t c = first + 1; c < last; ++c) {
+				if (less(heap[best], heap[c]))
+					best = c;
+			}
+			if (!less(x, heap[best]))
+				break;
+			heap[i] = heap[best];
+			i = best;
+		}
+		heap[i] = x;
+	}
+
+	Arraylist<T> heap;
+	Compare less{};
+};
+
+/* Heap that hands out a handle for every pushed element, so the element can
+ * later be changed or removed in O(D log n). Handles of removed elements are
+ * reused. Suited to Dijkstra style algorithms and timer queues */
+template <typename T, typename Compare = std::less<T>, std::size_t D = 2>
+class IndexedPriorityQueue {
+	static_assert(D >= 2, "A heap node needs at least two children");
+
+public:
+	using handle = std::size_t;
+
+	/* Inserts 'x' and returns its handle */
+	handle push(const T& x) {
+		handle h;
+		if (!free_handles.empty()) {
+			h = free_handles.pop_at_back();
+			values[h] = x;
+		} else {
+			h = values.size();
+			values.push_at_back(x);
+			position.push_at_back(npos);
+		}
+		heap.push_at_back(h);
+		position[h] = heap.size() - 1;
+		sift_up(heap.size() - 1);
+		return h;
+	}
+
+	/* Removes the top element and returns it */
+	T pop() {
+		if (empty())
+			throw std::out_of_range("Priority queue is empty");
+		T out = values[heap.front()];
+		erase(heap.front());
+		return out;
+	}
+
+	const T& top() const { return values[heap.front()]; }
+
+	/* Returns the handle of the top element */
+	handle top_handle() const { return heap.front(); }
+
+	/* Returns true if 'h' refers to an element still in the queue */
+	bool contains(handle h) const {
+		return h < position.size() && position[h] != npos;
+	}
+
+	/* Returns the element with handle 'h' */
+	const T& at(handle h) const {
+		if (!contains(h))
+			throw std::out_of_range("Invalid handle");
+		return values[h];
+	}
+
+	/* Replaces the element with handle 'h' by 'x', which moves it towards the
+	   top (for a min-heap built with std::greater: 'x' is a smaller key) */
+	void decrease_key(handle h, const T& x) {
+		if (!contains(h))
+			throw std::out_of_range("Invalid handle");
+		values[h] = x;
+		sift_up(position[h]);
+	}
+
+	/* Replaces the element with handle 'h' by 'x', in either direction */
+	void update(handle h, const T& x) {
+		if (!contains(h))
+			throw std::out_of_range("Invalid handle");
+		values[h] = x;
+		sift_down(sift_up(position[h]));
+	}
+
+	/* Removes the element with handle 'h' */
+	void erase(handle h) {
+		if (!contains(h))
+			throw std::out_of_range("Invalid handle");
+		std::size_t i = position[h];
+		handle last = heap.pop_at_back();
+		position[h] = npos;
+		free_handles.push_at_back(h);
+		if (i < heap.size()) {
+			heap[i] = last;
+			position[last] = i;
+			sift_down(sift_up(i));
+		}
+	}
+
+	void clear() {
+		heap.clear();
+		values.clear();
+		position.clear();
+		free_handles.clear();
+	}
+
+	bool empty() const { return heap.empty(); }
+
+	std::size_t size() const { return heap.size(); }
+
+private:
+	const static std::size_t npos{static_cast<std::size_t>(-1)};
+
+	bool less_at(std::size_t a, std::size_t b) const {
+		return less(values[heap[a]], values[heap[b]]);
+	}
+
+	void place(std::size_t i, handle h) {
+		heap[i] = h;
+		position[h] = i;
+	}
+
+	/* Returns the final position */
+	std::size_t sift_up(std::size_t i) {
+		handle h = heap[i];
+		while (i > 0) {
+			std::size_t parent = (i - 1) / D;
+			if (!less(values[heap[parent]], values[h]))
+				break;
+			place(i, heap[parent]);
+			i = parent;
+		}
+		place(i, h);
+		return i;
+	}
+
+	void sift_down(std::size_t i) {
+		handle h = heap[i];
+		std::size_t n = heap.size();
+		while (true) {
+			std::size_t first = D * i + 1;
+			if (first >= n)
+				break;
+			std::size_t last = first + D < n ? first + D : n;
+			std::size_t best = first;
+			for (std::size_t c = first + 1; c < last; ++c) {
+				if (less_at(best, c))
+					best = c;
+			}
+			if (!less(values[h], values[heap[best]]))
+				break;
+			place(i, heap[best]);
+			i = best;
+		}
+		place(i, h);
+	}
+
+	Arraylist<handle> heap;
+	Arraylist<T> values;
+	Arraylist<std::size_t> position;
+	Arraylist<handle> free_handles;
+	Compare less{};
+};
+
+template <typename T, typename Compare, std::size_t D>
+const std::size_t IndexedPriorityQueue<T, Compare, D>::npos;
+
+}
\ No newline at end of file
@@ -1,26 +1,44 @@
 #include <cstdint>
-#include <circular_list.h>
+#include <utility>
+#include <deque.h>
+#include <ring_buffer.h>
 
 namespace structures {
 
 template <typename T, typename Container>
 class QueueWrapper {
 public:
-	void push(const T& x) { return cont.push_at_back(x); }
+	/* Forwards the result of push_at_back (false when a Ringbuffer is full) */
+	auto push(const T& x)
+		-> decltype(std::declval<Container&>().push_at_back(x)) {
+		return cont.push_at_back(x);
+	}
 	T pop() { return cont.pop_at_front(); }
+	/* Pops the front into 'x', returns false (and never throws) when empty */
+	bool try_pop(T& x) {
+		if (cont.empty())
+			return false;
+		x = cont.pop_at_front();
+		return true;
+	}
 	T& front() { return cont.front(); }
 	const T& front() const { return cont.front(); }
 	T& back() { return cont.back(); }
 	const T& back() const { return cont.back(); }
 	void clear() { return cont.clear(); }
 	std::size_t size() const { return cont.size(); }
+	bool empty() const { return cont.empty(); }
 
 private:
 	Container cont;
 };
 
 template <typename T>
-class Queue : public QueueWrapper<T, Circularlist<T>> {};
+class Queue : public QueueWrapper<T, Deque<T>> {};
+
+/* Fixed capacity queue that never allocates, push returns false when full */
+template <typename T, std::size_t N>
+class StaticQueue : public QueueWrapper<T, Ringbuffer<T, N>> {};
 
 }  
 
@@ -0,0 +1,629 @@
+#include <cstdint>
+#include <string>
+#include <array_list.h>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#endif
+
+namespace structures {
+
+/* Adaptive radix tree (ART) set of byte string keys.
+ * Inner nodes grow and shrink between four layouts as their number of
+ * children changes (Node4, Node16, Node48 and Node256) and store the bytes
+ * that all keys below them share (path compression), so long shared prefixes
+ * such as URLs and paths are stored once. A key that ends at an inner node is
+ * kept in that node's 'terminal' leaf.
+ * Keys are visited in lexicographic byte order, and all keys with a given
+ * prefix can be visited without touching the rest of the tree. */
+class Radixtree {
+public:
+	Radixtree() = default;
+
+	Radixtree(const Radixtree& other) {
+		other.for_each([this](const std::string& key) { insert(key); });
+	}
+
+	Radixtree(Radixtree&& other) : root{other.root}, size_{other.size_} {
+		other.root = nullptr;
+		other.size_ = 0;
+	}
+
+	Radixtree& operator=(const Radixtree& other) {
+		Radixtree copy{other};
+		std::swap(root, copy.root);
+		std::swap(size_, copy.size_);
+		return *this;
+	}
+
+	Radixtree& operator=(Radixtree&& other) {
+		Radixtree copy{std::move(other)};
+		std::swap(root, copy.root);
+		std::swap(size_, copy.size_);
+		return *this;
+	}
+
+	~Radixtree() { destroy(root); }
+
+	void clear() {
+		destroy(root);
+		root = nullptr;
+		size_ = 0;
+	}
+
+	/* Inserts 'key', returns false if it is already in the tree */
+	bool insert(const std::string& key) {
+		if (!insert(root, key, 0))
+			return false;
+		++size_;
+		return true;
+	}
+
+	/* Removes 'key' from the tree, if it exists else return false */
+	bool remove(const std::string& key) {
+		if (!remove(root, key, 0))
+			return false;
+		--size_;
+		return true;
+	}
+
+	/* Returns true if the tree contains 'key' */
+	bool contains(const std::string& key) const {
+		const Node* n = root;
+		std::size_t depth = 0;
+		while (n) {
+			if (n->type == leaf)
+				return static_cast<const Leaf*>(n)->key == key;
+			auto inner = static_cast<const Inner*>(n);
+			if (key.compare(depth, inner->prefix.size(), inner->prefix) != 0)
+				return false;
+			depth += inner->prefix.size();
+			if (depth == key.size())
+				return inner->terminal != nullptr;
+			Node* const* child = find_child(inner, byte(key, depth));
+			n = child ? *child : nullptr;
+			++depth;
+		}
+		return false;
+	}
+
+	bool empty() const { return size_ == 0; }
+
+	/* Returns the number of keys */
+	std::size_t size() const { return size_; }
+
+	/* Calls 'f' on every key in lexicographic order */
+	template <typename F>
+	void for_each(F f) const {
+		visit(root, f);
+	}
+
+	/* Calls 'f' on every key starting with 'prefix', in lexicographic order */
+	template <typename F>
+	void for_each_prefix(const std::string& prefix, F f) const {
+		const Node* n = root;
+		std::size_t depth = 0;
+		while (n) {
+			if (n->type == leaf) {
+				auto& key = static_cast<const Leaf*>(n)->key;
+				if (key.compare(0, prefix.size(), prefix) == 0)
+					f(key);
+				return;
+			}
+			auto inner = static_cast<const Inner*>(n);
+			std::size_t rest = prefix.size() - depth;
+			if (rest <= inner->prefix.size()) {
+				// The query ends inside this node's prefix
+				if (inner->prefix.compare(0, rest, prefix, depth, rest) == 0)
+					visit(n, f);
+				return;
+			}
+			if (prefix.compare(depth, inner->prefix.size(), inner->prefix) != 0)
+				return;
+			depth += inner->prefix.size();
+			Node* const* child = find_child(inner, byte(prefix, depth));
+			n = child ? *child : nullptr;
+			++depth;
+			if (n && depth == prefix.size()) {
+				visit(n, f);
+				return;
+			}
+		}
+	}
+
+	/* Returns the keys in lexicographic order */
+	Arraylist<std::string> in_order() const {
+		Arraylist<std::string> out{size_ + 1};
+		for_each([&](const std::string& key) { out.push_at_back(key); });
+		return out;
+	}
+
+	/* Returns the keys starting with 'prefix' in lexicographic order */
+	Arraylist<std::string> with_prefix(const std::string& prefix) const {
+		Arraylist<std::string> out;
+		for_each_prefix(prefix, [&](const std::string& key) { out.push_at_back(key); });
+		return out;
+	}
+
+private:
+	enum Type : std::uint8_t { leaf, node4, node16, node48, node256 };
+
+	struct Node {
+		explicit Node(Type type_) : type{type_} {}
+		Type type;
+	};
+
+	struct Leaf : Node {
+		explicit Leaf(const std::string& key_) : Node{leaf}, key{key_} {}
+		std::string key;
+	};
+
+	struct Inner : Node {
+		explicit Inner(Type type_) : Node{type_} {}
+		std::uint16_t count{0};
+		std::string prefix;
+		Leaf* terminal{nullptr};
+	};
+
+	/* Node4 and Node16: sorted key bytes with the matching children */
+	template <Type Kind, int Capacity>
+	struct Small : Inner {
+		Small() : Inner{Kind} {}
+		unsigned char keys[Capacity]{};
+		Node* children[Capacity]{};
+	};
+
+	using Node4 = Small<node4, 4>;
+	using Node16 = Small<node16, 16>;
+
+	/* 256 entry index (slot + 1, 0 for none) into 48 children */
+	struct Node48 : Inner {
+		Node48() : Inner{node48} {}
+		unsigned char index[256]{};
+		Node* children[48]{};
+	};
+
+	struct Node256 : Inner {
+		Node256() : Inner{node256} {}
+		Node* children[256]{};
+	};
+
+	static unsigned char byte(const std::string& key, std::size_t i) {
+		return static_cast<unsigned char>(key[i]);
+	}
+
+	static Node* const* find_child(const Inner* n, unsigned char b) {
+		return find_child(const_cast<Inner*>(n), b);
+	}
+
+	static Node** find_child(Inner* n, unsigned char b) {
+		switch (n->type) {
+		case node4: {
+			auto s = static_cast<Node4*>(n);
+			for (int i = 0; i < s->count; ++i) {
+				if (s->keys[i] == b)
+					return &s->children[i];
+			}
+			return nullptr;
+		}
+		case node16: {
+			auto s = static_cast<Node16*>(n);
+#if defined(__SSE2__) && defined(__GNUC__)
+			// Compare all 16 key bytes at once
+			__m128i cmp = _mm_cmpeq_epi8(
+				_mm_set1_epi8(static_cast<char>(b)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(s->keys)));
+			int mask = _mm_movemask_epi8(cmp) & ((1 << s->count) - 1);
+			return mask ? &s->children[__builtin_ctz(mask)] : nullptr;
+#else
+			for (int i = 0; i < s->count; ++i) {
+				if (s->keys[i] == b)
+					return &s->children[i];
+			}
+			return nullptr;
+#endif
+		}
+		case node48: {
+			auto s = static_cast<Node48*>(n);
+			return s->index[b] ? &s->children[s->index[b] - 1] : nullptr;
+		}
+		default: {
+			auto s = static_cast<Node256*>(n);
+			return s->children[b] ? &s->children[b] : nullptr;
+		}
+		}
+	}
+
+	template <typename Big, typename Small_>
+	static Big* grow_small(Small_* s) {
+		Big* big = new Big;
+		move_header(s, big);
+		for (int i = 0; i < s->count; ++i) {
+			big->keys[i] = s->keys[i];
+			big->children[i] = s->children[i];
+		}
+		delete s;
+		return big;
+	}
+
+	static void move_header(Inner* from, Inner* to) {
+		to->count = from->count;
+		to->prefix = std::move(from->prefix);
+		to->terminal = from->terminal;
+		from->terminal = nullptr;
+	}
+
+	/* Adds 'child' under byte 'b', growing the node in 'ref' if it is full */
+	static void add_child(Node*& ref, unsigned char b, Node* child) {
+		auto n = static_cast<Inner*>(ref);
+		switch (n->type) {
+		case node4:
+			if (n->count == 4) {
+				ref = grow_small<Node16>(static_cast<Node4*>(n));
+				return add_child(ref, b, child);
+			}
+			return add_sorted(static_cast<Node4*>(n), b, child);
+		case node16:
+			if (n->count == 16) {
+				auto s = static_cast<Node16*>(n);
+				Node48* big = new Node48;
+				move_header(s, big);
+				for (int i = 0; i < 16; ++i) {
+					big->children[i] = s->children[i];
+					big->index[s->keys[i]] = static_cast<unsigned char>(i + 1);
+				}
+				delete s;
+				ref = big;
+				return add_child(ref, b, child);
+			}
+			return add_sorted(static_cast<Node16*>(n), b, child);
+		case node48: {
+			auto s = static_cast<Node48*>(n);
+			if (s->count == 48) {
+				Node256* big = new Node256;
+				move_header(s, big);
+				for (int i = 0; i < 256; ++i) {
+					if (s->index[i])
+						big->children[i] = s->children[s->index[i] - 1];
+				}
+				delete s;
+				ref = big;
+				return add_child(ref, b, child);
+			}
+			int slot = 0;
+			while (s->children[slot])
+				++slot;
+			s->children[slot] = child;
+			s->index[b] = static_cast<unsigned char>(slot + 1);
+			++s->count;
+			return;
+		}
+		default:
+			static_cast<Node256*>(n)->children[b] = child;
+			++n->count;
+		}
+	}
+
+	template <typename S>
+	static void add_sorted(S* s, unsigned char b, Node* child) {
+		int i = s->count;
+		while (i > 0 && s->keys[i - 1] > b) {
+			s->keys[i] = s->keys[i - 1];
+			s->children[i] = s->children[i - 1];
+			--i;
+		}
+		s->keys[i] = b;
+		s->children[i] = child;
+		++s->count;
+	}
+
+	/* Removes the child under byte 'b', shrinking the node in 'ref' if it
+	   has become sparse */
+	static void remove_child(Node*& ref, unsigned char b) {
+		auto n = static_cast<Inner*>(ref);
+		switch (n->type) {
+		case node4:
+			return remove_sorted(static_cast<Node4*>(n), b);
+		case node16:
+			remove_sorted(static_cast<Node16*>(n), b);
+			if (n->count <= 3) {
+				auto s = static_cast<Node16*>(n);
+				Node4* small = new Node4;
+				move_header(s, small);
+				for (int i = 0; i < s->count; ++i) {
+					small->keys[i] = s->keys[i];
+					small->children[i] = s->children[i];
+				}
+				delete s;
+				ref = small;
+			}
+			return;
+		case node48: {
+			auto s = static_cast<Node48*>(n);
+			s->children[s->index[b] - 1] = nullptr;
+			s->index[b] = 0;
+			--s->count;
+			if (s->count <= 12) {
+				Node16* small = new Node16;
+				move_header(s, small);
+				int j = 0;
+				for (int i = 0; i < 256; ++i) {
+					if (s->index[i]) {
+						small->keys[j] = static_cast<unsigned char>(i);
+						small->children[j++] = s->children[s->index[i] - 1];
+					}
+				}
+				delete s;
+				ref = small;
+			}
+			return;
+		}
+		default: {
+			auto s = static_cast<Node256*>(n);
+			s->children[b] = nullptr;
+			--s->count;
+			if (s->count <= 37) {
+				Node48* small = new Node48;
+				move_header(s, small);
+				int j = 0;
+				for (int i = 0; i < 256; ++i) {
+					if (s->children[i]) {
+						small->children[j] = s->children[i];
+						small->index[i] = static_cast<unsigned char>(++j);
+					}
+				}
+				delete s;
+				ref = small;
+			}
+		}
+		}
+	}
+
+	template <typename S>
+	static void remove_sorted(S* s, unsigned char b) {
+		int i = 0;
+		while (s->keys[i] != b)
+			++i;
+		for (--s->count; i < s->count; ++i) {
+			s->keys[i] = s->keys[i + 1];
+			s->children[i] = s->children[i + 1];
+		}
+		s->children[s->count] = nullptr;
+	}
+
+	/* Returns the single child of an inner node with one child */
+	static Node* only_child(Inner* n, unsigned char& b) {
+		switch (n->type) {
+		case node4:
+			b = static_cast<Node4*>(n)->keys[0];
+			return static_cast<Node4*>(n)->children[0];
+		case node16:
+			b = static_cast<Node16*>(n)->keys[0];
+			return static_cast<Node16*>(n)->children[0];
+		case node48:
+			for (int i = 0; i < 256; ++i) {
+				if (static_cast<Node48*>(n)->index[i]) {
+					b = static_cast<unsigned char>(i);
+					return static_cast<Node48*>(n)->children
+						[static_cast<Node48*>(n)->index[i] - 1];
+				}
+			}
+			return nullptr;
+		default:
+			for (int i = 0; i < 256; ++i) {
+				if (static_cast<Node256*>(n)->children[i]) {
+					b = static_cast<unsigned char>(i);
+					return static_cast<Node256*>(n)->children[i];
+				}
+			}
+			return nullptr;
+		}
+	}
+
+	static bool insert(Node*& ref, const std::string& key, std::size_t depth) {
+		if (!ref) {
+			ref = new Leaf(key);
+			return true;
+		}
+
+		if (ref->type == leaf) {
+			auto old = static_cast<Leaf*>(ref);
+			if (old->key == key)
+				return false;
+			// Split the leaf into a Node4 holding the shared part of both keys
+			Node4* n = new Node4;
+			std::size_t p = depth;
+			while (p < key.size() && p < old->key.size() && key[p] == old->key[p])
+				++p;
+			n->prefix = key.substr(depth, p - depth);
+			Node* split = n;
+			attach(split, old, p);
+			attach(split, new Leaf(key), p);
+			ref = split;
+			return true;
+		}
+
+		auto n = static_cast<Inner*>(ref);
+		std::size_t p = 0;
+		while (p < n->prefix.size() && depth + p < key.size() &&
+			   n->prefix[p] == key[depth + p])
+			++p;
+		if (p < n->prefix.size()) {
+			// The key leaves the compressed path: split the path at 'p'
+			Node4* parent = new Node4;
+			parent->prefix = n->prefix.substr(0, p);
+			unsigned char b = static_cast<unsigned char>(n->prefix[p]);
+			n->prefix.erase(0, p + 1);
+			Node* split = parent;
+			add_child(split, b, n);
+			attach(split, new Leaf(key), depth + p);
+			ref = split;
+			return true;
+		}
+
+		depth += n->prefix.size();
+		if (depth == key.size()) {
+			if (n->terminal)
+				return false;
+			n->terminal = new Leaf(key);
+			return true;
+		}
+		Node** child = find_child(n, byte(key, depth));
+		if (child)
+			return insert(*child, key, depth + 1);
+		add_child(ref, byte(key, depth), new Leaf(key));
+		return true;
+	}
+
+	/* Hangs 'l' below the fresh inner node 'ref' whose path ends at 'depth' */
+	static void attach(Node*& ref, Leaf* l, std::size_t depth) {
+		if (l->key.size() == depth)
+			static_cast<Inner*>(ref)->terminal = l;
+		else
+			add_child(ref, byte(l->key, depth), l);
+	}
+
+	static bool remove(Node*& ref, const std::string& key, std::size_t depth) {
+		if (!ref)
+			return false;
+
+		if (ref->type == leaf) {
+			if (static_cast<Leaf*>(ref)->key != key)
+				return false;
+			delete static_cast<Leaf*>(ref);
+			ref = nullptr;
+			return true;
+		}
+
+		auto n = static_cast<Inner*>(ref);
+		if (key.compare(depth, n->prefix.size(), n->prefix) != 0)
+			return false;
+		depth += n->prefix.size();
+		if (depth == key.size()) {
+			if (!n->terminal)
+				return false;
+			delete n->terminal;
+			n->terminal = nullptr;
+		} else {
+			unsigned char b = byte(key, depth);
+			Node** child = find_child(n, b);
+			if (!child || !remove(*child, key, depth + 1))
+				return false;
+			if (!*child)
+				remove_child(ref, b);
+		}
+		collapse(ref);
+		return true;
+	}
+
+	/* Replaces an inner node left with a single entry by that entry */
+	static void collapse(Node*& ref) {
+		auto n = static_cast<Inner*>(ref);
+		if (n->count == 0) {
+			ref = n->terminal;
+			n->terminal = nullptr;
+			destroy(n);
+		} else if (n->count == 1 && !n->terminal) {
+			unsigned char b;
+			Node* child = only_child(n, b);
+			if (child->type != leaf) {
+				auto c = static_cast<Inner*>(child);
+				c->prefix = n->prefix + static_cast<char>(b) + c->prefix;
+			}
+			n->count = 0;
+			destroy(n);
+			ref = child;
+		}
+	}
+
+	template <typename F>
+	static void visit(const Node* n, F& f) {
+		if (!n)
+			return;
+		if (n->type == leaf) {
+			f(static_cast<const Leaf*>(n)->key);
+			return;
+		}
+		auto inner = static_cast<const Inner*>(n);
+		if (inner->terminal)
+			f(inner->terminal->key);
+		switch (n->type) {
+		case node4: {
+			auto s = static_cast<const Node4*>(n);
+			for (int i = 0; i < s->count; ++i)
+				visit(s->children[i], f);
+			break;
+		}
+		case node16: {
+			auto s = static_cast<const Node16*>(n);
+			for (int i = 0; i < s->count; ++i)
+				visit(s->children[i], f);
+			break;
+		}
+		case node48: {
+			auto s = static_cast<const Node48*>(n);
+			for (int i = 0; i < 256; ++i) {
+				if (s->index[i])
+					visit(s->children[s->index[i] - 1], f);
+			}
+			break;
+		}
+		default: {
+			auto s = static_cast<const Node256*>(n);
+			for (int i = 0; i < 256; ++i)
+				visit(s->children[i], f);
+		}
+		}
+	}
+
+	/* Deletes 'n' and, unless its count was cleared, everything below it */
+	static void destroy(Node* n) {
+		if (!n)
+			return;
+		switch (n->type) {
+		case leaf:
+			delete static_cast<Leaf*>(n);
+			return;
+		case node4: {
+			auto s = static_cast<Node4*>(n);
+			for (int i = 0; i < s->count; ++i)
+				destroy(s->children[i]);
+			destroy(s->terminal);
+			delete s;
+			return;
+		}
+		case node16: {
+			auto s = static_cast<Node16*>(n);
+			for (int i = 0; i < s->count; ++i)
+				destroy(s->children[i]);
+			destroy(s->terminal);
+			delete s;
+			return;
+		}
+		case node48: {
+			auto s = static_cast<Node48*>(n);
+			if (s->count > 0) {
+				for (int i = 0; i < 48; ++i)
+					destroy(s->children[i]);
+			}
+			destroy(s->terminal);
+			delete s;
+			return;
+		}
+		default: {
+			auto s = static_cast<Node256*>(n);
+			if (s->count > 0) {
+				for (int i = 0; i < 256; ++i)
+					destroy(s->children[i]);
+			}
+			destroy(s->terminal);
+			delete s;
+		}
+		}
+	}
+
+	Node* root{nullptr};
+	std::size_t size_{0u};
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <cstdint>
+#include <stdexcept>
+
+namespace structures {
+
+/* Fixed capacity double ended ring buffer stored inline (no heap
+   allocation), capacity given by the template parameter 'N'. Insertions
+   return false instead of throwing when the buffer is full */
+template <typename T, std::size_t N>
+class Ringbuffer {
+public:
+	constexpr Ringbuffer() = default;
+
+	/* Clears all elements of the buffer */
+	void clear() {
+		head = 0;
+		size_ = 0;
+	}
+
+	/* Insert the element 'x' at the end, false if the buffer is full */
+	bool push_at_back(const T& x) {
+		if (full())
+			return false;
+		contents[wrap(head + size_)] = x;
+		++size_;
+		return true;
+	}
+
+	/* Insert the element 'x' at the beginning, false if the buffer is full */
+	bool push_at_front(const T& x) {
+		if (full())
+			return false;
+		head = head == 0 ? N - 1 : head - 1;
+		contents[head] = x;
+		++size_;
+		return true;
+	}
+
+	/* Remove an element at the end of the buffer */
+	T pop_at_back() {
+		if (empty())
+			throw std::out_of_range("Buffer is empty (pop_at_back())");
+		--size_;
+		return contents[wrap(head + size_)];
+	}
+
+	/* Remove an element at the beginning of the buffer */
+	T pop_at_front() {
+		if (empty())
+			throw std::out_of_range("Buffer is empty (pop_at_front())");
+		T out = contents[head];
+		head = wrap(head + 1);
+		--size_;
+		return out;
+	}
+
+	/* Return true if buffer is empty */
+	constexpr bool empty() const { return size_ == 0; }
+
+	/* Return true if no more elements fit */
+	constexpr bool full() const { return size_ == N; }
+
+	/* Return reference of element in given index 'index' */
+	T& at(std::size_t index) {
+		return const_cast<T&>(static_cast<const Ringbuffer*>(this)->at(index));
+	}
+
+	const T& at(std::size_t index) const {
+		if (index >= size_)
+			throw std::out_of_range("Index out of bounds");
+		return contents[wrap(head + index)];
+	}
+
+	T& operator[](std::size_t index) { return contents[wrap(head + index)]; }
+
+	const T& operator[](std::size_t index) const {
+		return contents[wrap(head + index)];
+	}
+
+	/* Return size of buffer */
+	constexpr std::size_t size() const { return size_; }
+
+	/* Return the maximum number of elements */
+	constexpr std::size_t capacity() const { return N; }
+
+	T& front() { return contents[head]; }
+
+	const T& front() const { return contents[head]; }
+
+	T& back() { return contents[wrap(head + size_ - 1)]; }
+
+	const T& back() const { return contents[wrap(head + size_ - 1)]; }
+
+private:
+	/* 'i' is always below 2 * N, so one subtraction replaces a modulo */
+	static std::size_t wrap(std::size_t i) { return i >= N ? i - N : i; }
+
+	T contents[N]{};
+	std::size_t head{0u};
+	std::size_t size_{0u};
+};
+
+}
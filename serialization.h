@@ -0,0 +1,452 @@
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace structures {
+
+/* Declared here so the writers and readers below can be used with whichever
+   container headers are included */
+template <typename T>
+class Arraylist;
+template <typename T, typename Node>
+class Tree;
+template <typename T, typename Hash, typename Reduce, typename Filter>
+class Hashtablewrapper;
+
+/* Binary format for containers of trivially copyable elements.
+ * A file is a 64 byte header followed by the payload:
+ *   list:    the elements in list order
+ *   sorted:  the elements in ascending order (written from a Tree)
+ *   hashset: an open addressed table of 'capacity' slots: an array of 64 bit
+ *            hash tags (0 = empty slot) and then an array of keys
+ * Every array starts at a multiple of 64 bytes from the start of the file, so
+ * a memory mapped file can be queried in place through the Frozen* views.
+ * Values are stored in native byte order; 'byte_order' rejects files written
+ * on a machine with a different one. */
+namespace serialization {
+
+const std::uint32_t magic{0x31534442};  // "BDS1"
+const std::uint32_t version{1};
+const std::uint32_t byte_order{0x01020304};
+const std::size_t alignment{64};
+const std::size_t chunk{4096};
+
+enum class Kind : std::uint32_t { list = 1, sorted = 2, hashset = 3 };
+
+struct Header {
+	std::uint32_t magic;
+	std::uint32_t version;
+	std::uint32_t byte_order;
+	Kind kind;
+	std::uint64_t element_size;
+	std::uint64_t count;
+	std::uint64_t capacity;
+	char reserved[24];
+};
+
+static_assert(sizeof(Header) == alignment, "Header must fill one block");
+
+inline std::size_t padded(std::size_t bytes) {
+	return (bytes + alignment - 1) / alignment * alignment;
+}
+
+/* Bytes taken by 'count' elements of 'size' bytes. Throws if that (plus
+   its padding) does not fit a size_t, as only a corrupt header asks for it */
+inline std::size_t array_bytes(std::uint64_t count, std::size_t size) {
+	if (count > (std::numeric_limits<std::size_t>::max() - alignment) / size)
+		throw std::runtime_error("Corrupt binary file header");
+	return static_cast<std::size_t>(count) * size;
+}
+
+/* Slot of a hash tag in a table of 2^bits slots, by Fibonacci hashing */
+inline std::size_t slot_of(std::uint64_t tag, unsigned bits) {
+	if (bits == 0)
+		return 0;
+	return static_cast<std::size_t>((tag * 11400714819323198485ULL) >> (64 - bits));
+}
+
+inline std::uint64_t tag_of(std::size_t hash) {
+	return static_cast<std::uint64_t>(hash) | 1u;
+}
+
+template <typename T>
+void write_header(std::ostream& out, Kind kind, std::uint64_t count,
+				  std::uint64_t capacity) {
+	static_assert(std::is_trivially_copyable<T>::value,
+				  "Only trivially copyable elements can be serialized");
+	Header h{};
+	h.magic = magic;
+	h.version = version;
+	h.byte_order = byte_order;
+	h.kind = kind;
+	h.element_size = sizeof(T);
+	h.count = count;
+	h.capacity = capacity;
+	out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+}
+
+template <typename T>
+Header check_header(const Header& h, Kind kind) {
+	if (h.magic != magic)
+		throw std::runtime_error("Not a structures binary file");
+	if (h.version != version || h.byte_order != byte_order)
+		throw std::runtime_error("Unsupported binary format version");
+	if (h.kind != kind)
+		throw std::runtime_error("Binary file holds another container");
+	if (h.element_size != sizeof(T))
+		throw std::runtime_error("Binary file holds another element type");
+	// Probing relies on a power of two table with at least one empty slot
+	if (kind == Kind::hashset &&
+		(h.capacity == 0 || (h.capacity & (h.capacity - 1)) != 0 || h.count >= h.capacity))
+		throw std::runtime_error("Corrupt binary file header");
+	return h;
+}
+
+template <typename T>
+Header read_header(std::istream& in, Kind kind) {
+	Header h{};
+	if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)))
+		throw std::runtime_error("Truncated binary file");
+	return check_header<T>(h, kind);
+}
+
+/* Validates the header at the start of a mapped file of 'bytes' bytes */
+template <typename T>
+Header map_header(const void* data, std::size_t bytes, Kind kind) {
+	if (bytes < sizeof(Header))
+		throw std::runtime_error("Truncated binary file");
+	Header h;
+	std::memcpy(&h, data, sizeof(h));
+	check_header<T>(h, kind);
+	std::size_t left = bytes - sizeof(Header);
+	auto take = [&](std::size_t more) {
+		if (more > left)
+			throw std::runtime_error("Truncated binary file");
+		left -= more;
+	};
+	if (kind == Kind::hashset) {
+		take(padded(array_bytes(h.capacity, sizeof(std::uint64_t))));
+		take(array_bytes(h.capacity, sizeof(T)));
+	} else {
+		take(array_bytes(h.count, sizeof(T)));
+	}
+	return h;
+}
+
+template <typename T>
+void write_elements(std::ostream& out, const T* data, std::size_t n) {
+	out.write(reinterpret_cast<const char*>(data), n * sizeof(T));
+}
+
+inline void write_padding(std::ostream& out, std::size_t bytes) {
+	static const char zeros[alignment] = {};
+	out.write(zeros, padded(bytes) - bytes);
+}
+
+/* Reads 'n' elements in chunks, handing each one to 'sink' */
+template <typename T, typename Sink>
+void read_elements(std::istream& in, std::uint64_t n, Sink sink) {
+	std::unique_ptr<T[]> buffer{new T[chunk]};
+	while (n > 0) {
+		std::size_t len = n < chunk ? static_cast<std::size_t>(n) : chunk;
+		if (!in.read(reinterpret_cast<char*>(buffer.get()), len * sizeof(T)))
+			throw std::runtime_error("Truncated binary file");
+		for (std::size_t i = 0; i < len; i++)
+			sink(buffer[i]);
+		n -= len;
+	}
+}
+
+/* Inserts sorted[lo, hi) median first, so an unbalanced tree comes out
+   balanced */
+template <typename T, typename Node>
+void insert_balanced(Tree<T, Node>& tree, const Arraylist<T>& sorted,
+					 std::size_t lo, std::size_t hi) {
+	if (lo >= hi)
+		return;
+	std::size_t mid = lo + (hi - lo) / 2;
+	tree.insert(sorted[mid]);
+	insert_balanced(tree, sorted, lo, mid);
+	insert_balanced(tree, sorted, mid + 1, hi);
+}
+
+}  // namespace serialization
+
+/* Writes the elements of 'list' */
+template <typename T>
+void write_binary(std::ostream& out, const Arraylist<T>& list) {
+	using namespace serialization;
+	write_header<T>(out, Kind::list, list.size(), list.size());
+	if (!list.empty())
+		write_elements(out, &list[0], list.size());
+}
+
+/* Writes the elements of 'tree' in ascending order */
+template <typename T, typename Node>
+void write_binary(std::ostream& out, const Tree<T, Node>& tree) {
+	using namespace serialization;
+	auto sorted = tree.in_order();
+	write_header<T>(out, Kind::sorted, sorted.size(), sorted.size());
+	if (!sorted.empty())
+		write_elements(out, &sorted[0], sorted.size());
+}
+
+/* Writes 'table' as an open addressed table at most half full. Frozenhashtable
+   must be used with the same 'Hash' to query it */
+template <typename T, typename Hash, typename Reduce, typename Filter>
+void write_binary(std::ostream& out,
+				  const Hashtablewrapper<T, Hash, Reduce, Filter>& table) {
+	using namespace serialization;
+	auto items = table.items();
+	unsigned bits = 3;
+	while ((std::size_t{1} << bits) < 2 * items.size())
+		++bits;
+	std::size_t capacity = std::size_t{1} << bits;
+	std::size_t mask = capacity - 1;
+
+	std::unique_ptr<std::uint64_t[]> tags{new std::uint64_t[capacity]()};
+	std::unique_ptr<T[]> keys{new T[capacity]()};
+	Hash hashf{};
+	for (std::size_t i = 0; i < items.size(); i++) {
+		std::uint64_t tag = tag_of(hashf(items[i]));
+		std::size_t s = slot_of(tag, bits);
+		while (tags[s] != 0)
+			s = (s + 1) & mask;
+		tags[s] = tag;
+		keys[s] = items[i];
+	}
+
+	write_header<T>(out, Kind::hashset, items.size(), capacity);
+	write_elements(out, tags.get(), capacity);
+	write_padding(out, capacity * sizeof(std::uint64_t));
+	write_elements(out, keys.get(), capacity);
+}
+
+/* Appends the elements of a list written by write_binary to 'list' */
+template <typename T>
+void read_binary(std::istream& in, Arraylist<T>& list) {
+	using namespace serialization;
+	auto h = read_header<T>(in, Kind::list);
+	read_elements<T>(in, h.count, [&](const T& x) { list.push_at_back(x); });
+}
+
+/* Inserts the elements of a tree written by write_binary into 'tree'. They
+   are inserted median first, so an unbalanced tree is rebuilt balanced */
+template <typename T, typename Node>
+void read_binary(std::istream& in, Tree<T, Node>& tree) {
+	using namespace serialization;
+	auto h = read_header<T>(in, Kind::sorted);
+	Arraylist<T> sorted{static_cast<std::size_t>(h.count) + 1};
+	read_elements<T>(in, h.count, [&](const T& x) { sorted.push_at_back(x); });
+	insert_balanced(tree, sorted, 0, sorted.size());
+}
+
+/* Inserts the elements of a table written by write_binary into 'table' */
+template <typename T, typename Hash, typename Reduce, typename Filter>
+void read_binary(std::istream& in, Hashtablewrapper<T, Hash, Reduce, Filter>& table) {
+	using namespace serialization;
+	auto h = read_header<T>(in, Kind::hashset);
+	std::size_t tag_bytes = array_bytes(h.capacity, sizeof(std::uint64_t));
+	std::unique_ptr<std::uint64_t[]> tags{new std::uint64_t[h.capacity]};
+	if (!in.read(reinterpret_cast<char*>(tags.get()), tag_bytes) ||
+		!in.ignore(padded(tag_bytes) - tag_bytes))
+		throw std::runtime_error("Truncated binary file");
+	std::size_t s = 0;
+	read_elements<T>(in, h.capacity, [&](const T& x) {
+		if (tags[s++] != 0)
+			table.insert(x);
+	});
+}
+
+/* Read only memory mapping of a whole file */
+class Mappedfile {
+public:
+	explicit Mappedfile(const std::string& path) {
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error("Cannot open " + path);
+		struct stat st;
+		if (::fstat(fd, &st) != 0) {
+			::close(fd);
+			throw std::runtime_error("Cannot stat " + path);
+		}
+		size_ = static_cast<std::size_t>(st.st_size);
+		if (size_ > 0) {
+			data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data_ == MAP_FAILED) {
+				::close(fd);
+				throw std::runtime_error("Cannot map " + path);
+			}
+		}
+		::close(fd);
+	}
+
+	Mappedfile(const Mappedfile&) = delete;
+	Mappedfile& operator=(const Mappedfile&) = delete;
+
+	Mappedfile(Mappedfile&& other) : data_{other.data_}, size_{other.size_} {
+		other.data_ = nullptr;
+		other.size_ = 0;
+	}
+
+	Mappedfile& operator=(Mappedfile&& other) {
+		std::swap(data_, other.data_);
+		std::swap(size_, other.size_);
+		return *this;
+	}
+
+	~Mappedfile() {
+		if (data_)
+			::munmap(data_, size_);
+	}
+
+	const void* data() const { return data_; }
+
+	std::size_t size() const { return size_; }
+
+private:
+	void* data_{nullptr};
+	std::size_t size_{0u};
+};
+
+/* Read only list over a list written by write_binary, typically memory
+   mapped. Nothing is copied; 'data' must outlive the view */
+template <typename T>
+class Frozenarraylist {
+public:
+	Frozenarraylist(const void* data, std::size_t bytes) {
+		using namespace serialization;
+		auto h = map_header<T>(data, bytes, Kind::list);
+		contents = reinterpret_cast<const T*>(
+			static_cast<const char*>(data) + sizeof(Header));
+		size_ = static_cast<std::size_t>(h.count);
+	}
+
+	bool empty() const { return size_ == 0; }
+
+	std::size_t size() const { return size_; }
+
+	bool contains(const T& data) const { return find(data) != size_; }
+
+	/* Return the position of 'data' in the list */
+	std::size_t find(const T& data) const {
+		for (std::size_t i = 0; i < size_; ++i) {
+			if (contents[i] == data)
+				return i;
+		}
+		return size_;
+	}
+
+	const T& at(std::size_t index) const {
+		if (index >= size_)
+			throw std::out_of_range("Index out of bounds");
+		return contents[index];
+	}
+
+	const T& operator[](std::size_t index) const { return contents[index]; }
+
+private:
+	const T* contents;
+	std::size_t size_;
+};
+
+/* Read only ordered set over a tree written by write_binary (a sorted array),
+   queried in place by binary search */
+template <typename T>
+class Frozentree {
+public:
+	Frozentree(const void* data, std::size_t bytes) {
+		using namespace serialization;
+		auto h = map_header<T>(data, bytes, Kind::sorted);
+		contents = reinterpret_cast<const T*>(
+			static_cast<const char*>(data) + sizeof(Header));
+		size_ = static_cast<std::size_t>(h.count);
+	}
+
+	bool empty() const { return size_ == 0; }
+
+	std::size_t size() const { return size_; }
+
+	/* Returns the position of the first element not less than 'x' */
+	std::size_t lower_bound(const T& x) const {
+		std::size_t lo = 0, hi = size_;
+		while (lo < hi) {
+			std::size_t mid = lo + (hi - lo) / 2;
+			if (contents[mid] < x)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	/* Returns true if the tree contains 'x' */
+	bool contains(const T& x) const {
+		std::size_t i = lower_bound(x);
+		return i < size_ && !(x < contents[i]);
+	}
+
+	/* Returns the 'index'th smallest element */
+	const T& operator[](std::size_t index) const { return contents[index]; }
+
+private:
+	const T* contents;
+	std::size_t size_;
+};
+
+/* Read only set over a hash table written by write_binary, queried in place
+   by linear probing. 'Hash' must be the hash the table was written with */
+template <typename T, typename Hash = std::hash<T>>
+class Frozenhashtable {
+public:
+	Frozenhashtable(const void* data, std::size_t bytes) {
+		using namespace serialization;
+		auto h = map_header<T>(data, bytes, Kind::hashset);
+		auto base = static_cast<const char*>(data) + sizeof(Header);
+		tags = reinterpret_cast<const std::uint64_t*>(base);
+		keys = reinterpret_cast<const T*>(
+			base + padded(h.capacity * sizeof(std::uint64_t)));
+		size_ = static_cast<std::size_t>(h.count);
+		mask = static_cast<std::size_t>(h.capacity) - 1;
+		while ((std::size_t{1} << bits) < h.capacity)
+			++bits;
+	}
+
+	std::size_t size() const { return size_; }
+
+	/* Returns true if the element 'x' is in the table */
+	bool contains(const T& x) const {
+		using namespace serialization;
+		std::uint64_t tag = tag_of(hashf(x));
+		std::size_t s = slot_of(tag, bits);
+		// Bounded by the capacity, so a file without empty slots cannot hang
+		for (std::size_t n = 0; n <= mask && tags[s] != 0; ++n, s = (s + 1) & mask) {
+			if (tags[s] == tag && keys[s] == x)
+				return true;
+		}
+		return false;
+	}
+
+private:
+	const std::uint64_t* tags;
+	const T* keys;
+	std::size_t size_;
+	std::size_t mask;
+	unsigned bits{0};
+
+	Hash hashf{};
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,420 @@
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STRUCTURES_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace structures {
+
+/* Search kernels for arrays of arithmetic elements: find, count, min and max.
+ * On x86 with GCC or Clang, 32 and 64 bit integers, floats and doubles use
+ * SSE2, AVX2 or AVX-512 code, picked at run time from what the CPU supports;
+ * every other type (and every other platform) uses plain loops.
+ * min and max assume the elements contain no NaN. */
+namespace simd {
+
+/* Plain loops, used for any type the vector kernels do not cover */
+template <typename T>
+struct Scalar {
+	static std::size_t find(const T* data, std::size_t n, const T& x) {
+		for (std::size_t i = 0; i < n; ++i) {
+			if (data[i] == x)
+				return i;
+		}
+		return n;
+	}
+
+	static std::size_t count(const T* data, std::size_t n, const T& x) {
+		std::size_t c = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			c += data[i] == x ? 1 : 0;
+		return c;
+	}
+
+	/* Position of the smallest element ('n' if there are none) */
+	static std::size_t min(const T* data, std::size_t n) {
+		std::size_t best = 0;
+		for (std::size_t i = 1; i < n; ++i) {
+			if (data[i] < data[best])
+				best = i;
+		}
+		return n == 0 ? n : best;
+	}
+
+	/* Position of the largest element ('n' if there are none) */
+	static std::size_t max(const T* data, std::size_t n) {
+		std::size_t best = 0;
+		for (std::size_t i = 1; i < n; ++i) {
+			if (data[best] < data[i])
+				best = i;
+		}
+		return n == 0 ? n : best;
+	}
+};
+
+#if defined(STRUCTURES_SIMD_X86)
+
+enum class Isa { sse2, avx2, avx512 };
+
+/* Best instruction set of the running CPU, detected once */
+inline Isa isa() {
+	static const Isa detected = [] {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+			return Isa::avx512;
+		if (__builtin_cpu_supports("avx2"))
+			return Isa::avx2;
+		return Isa::sse2;
+	}();
+	return detected;
+}
+
+/* Lane operations, one struct per instruction set and element type. Each
+ * provides: V (register type), lanes, load, set1, eq (bit mask of equal
+ * lanes), min and max. The integer ones take the element type itself, so
+ * int, long and long long are read through their own pointer types.
+ * AVX-512 min and max use the masked forms with every lane selected: GCC
+ * fills the unmasked forms' pass-through operand from an uninitialized
+ * placeholder, which trips -Wmaybe-uninitialized in the including code */
+#define STRUCTURES_TARGET(isa_) __attribute__((target(isa_), always_inline)) inline
+
+template <typename T_>
+struct Sse2i32 {
+	using T = T_;
+	using V = __m128i;
+	const static int lanes = 4;
+	STRUCTURES_TARGET("sse2") static V load(const T* p) { return _mm_loadu_si128(reinterpret_cast<const V*>(p)); }
+	STRUCTURES_TARGET("sse2") static V set1(T x) { return _mm_set1_epi32(x); }
+	STRUCTURES_TARGET("sse2") static unsigned eq(V a, V b) {
+		return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+	}
+	STRUCTURES_TARGET("sse2") static V min(V a, V b) {
+		V lt = _mm_cmplt_epi32(a, b);
+		return _mm_or_si128(_mm_and_si128(lt, a), _mm_andnot_si128(lt, b));
+	}
+	STRUCTURES_TARGET("sse2") static V max(V a, V b) {
+		V gt = _mm_cmpgt_epi32(a, b);
+		return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+	}
+};
+
+template <typename T_>
+struct Sse2i64 {
+	using T = T_;
+	using V = __m128i;
+	const static int lanes = 2;
+	STRUCTURES_TARGET("sse2") static V load(const T* p) { return _mm_loadu_si128(reinterpret_cast<const V*>(p)); }
+	STRUCTURES_TARGET("sse2") static V set1(T x) { return _mm_set1_epi64x(x); }
+	STRUCTURES_TARGET("sse2") static unsigned eq(V a, V b) {
+		// 64 bit lanes are equal when both of their 32 bit halves are
+		V c = _mm_cmpeq_epi32(a, b);
+		c = _mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_movemask_pd(_mm_castsi128_pd(c));
+	}
+	// SSE2 has no 64 bit compare: min and max go lane by lane
+	STRUCTURES_TARGET("sse2") static V min(V a, V b) {
+		T x[2], y[2];
+		std::memcpy(x, &a, 16);
+		std::memcpy(y, &b, 16);
+		return _mm_set_epi64x(y[1] < x[1] ? y[1] : x[1], y[0] < x[0] ? y[0] : x[0]);
+	}
+	STRUCTURES_TARGET("sse2") static V max(V a, V b) {
+		T x[2], y[2];
+		std::memcpy(x, &a, 16);
+		std::memcpy(y, &b, 16);
+		return _mm_set_epi64x(x[1] < y[1] ? y[1] : x[1], x[0] < y[0] ? y[0] : x[0]);
+	}
+};
+
+struct Sse2f32 {
+	using T = float;
+	using V = __m128;
+	const static int lanes = 4;
+	STRUCTURES_TARGET("sse2") static V load(const T* p) { return _mm_loadu_ps(p); }
+	STRUCTURES_TARGET("sse2") static V set1(T x) { return _mm_set1_ps(x); }
+	STRUCTURES_TARGET("sse2") static unsigned eq(V a, V b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+	STRUCTURES_TARGET("sse2") static V min(V a, V b) { return _mm_min_ps(a, b); }
+	STRUCTURES_TARGET("sse2") static V max(V a, V b) { return _mm_max_ps(a, b); }
+};
+
+struct Sse2f64 {
+	using T = double;
+	using V = __m128d;
+	const static int lanes = 2;
+	STRUCTURES_TARGET("sse2") static V load(const T* p) { return _mm_loadu_pd(p); }
+	STRUCTURES_TARGET("sse2") static V set1(T x) { return _mm_set1_pd(x); }
+	STRUCTURES_TARGET("sse2") static unsigned eq(V a, V b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+	STRUCTURES_TARGET("sse2") static V min(V a, V b) { return _mm_min_pd(a, b); }
+	STRUCTURES_TARGET("sse2") static V max(V a, V b) { return _mm_max_pd(a, b); }
+};
+
+template <typename T_>
+struct Avx2i32 {
+	using T = T_;
+	using V = __m256i;
+	const static int lanes = 8;
+	STRUCTURES_TARGET("avx2") static V load(const T* p) { return _mm256_loadu_si256(reinterpret_cast<const V*>(p)); }
+	STRUCTURES_TARGET("avx2") static V set1(T x) { return _mm256_set1_epi32(x); }
+	STRUCTURES_TARGET("avx2") static unsigned eq(V a, V b) {
+		return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+	}
+	STRUCTURES_TARGET("avx2") static V min(V a, V b) { return _mm256_min_epi32(a, b); }
+	STRUCTURES_TARGET("avx2") static V max(V a, V b) { return _mm256_max_epi32(a, b); }
+};
+
+template <typename T_>
+struct Avx2i64 {
+	using T = T_;
+	using V = __m256i;
+	const static int lanes = 4;
+	STRUCTURES_TARGET("avx2") static V load(const T* p) { return _mm256_loadu_si256(reinterpret_cast<const V*>(p)); }
+	STRUCTURES_TARGET("avx2") static V set1(T x) { return _mm256_set1_epi64x(x); }
+	STRUCTURES_TARGET("avx2") static unsigned eq(V a, V b) {
+		return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)));
+	}
+	STRUCTURES_TARGET("avx2") static V min(V a, V b) {
+		return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+	}
+	STRUCTURES_TARGET("avx2") static V max(V a, V b) {
+		return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+	}
+};
+
+struct Avx2f32 {
+	using T = float;
+	using V = __m256;
+	const static int lanes = 8;
+	STRUCTURES_TARGET("avx2") static V load(const T* p) { return _mm256_loadu_ps(p); }
+	STRUCTURES_TARGET("avx2") static V set1(T x) { return _mm256_set1_ps(x); }
+	STRUCTURES_TARGET("avx2") static unsigned eq(V a, V b) {
+		return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ));
+	}
+	STRUCTURES_TARGET("avx2") static V min(V a, V b) { return _mm256_min_ps(a, b); }
+	STRUCTURES_TARGET("avx2") static V max(V a, V b) { return _mm256_max_ps(a, b); }
+};
+
+struct Avx2f64 {
+	using T = double;
+	using V = __m256d;
+	const static int lanes = 4;
+	STRUCTURES_TARGET("avx2") static V load(const T* p) { return _mm256_loadu_pd(p); }
+	STRUCTURES_TARGET("avx2") static V set1(T x) { return _mm256_set1_pd(x); }
+	STRUCTURES_TARGET("avx2") static unsigned eq(V a, V b) {
+		return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ));
+	}
+	STRUCTURES_TARGET("avx2") static V min(V a, V b) { return _mm256_min_pd(a, b); }
+	STRUCTURES_TARGET("avx2") static V max(V a, V b) { return _mm256_max_pd(a, b); }
+};
+
+template <typename T_>
+struct Avx512i32 {
+	using T = T_;
+	using V = __m512i;
+	const static int lanes = 16;
+	STRUCTURES_TARGET("avx512f") static V load(const T* p) { return _mm512_loadu_si512(p); }
+	STRUCTURES_TARGET("avx512f") static V set1(T x) { return _mm512_set1_epi32(x); }
+	STRUCTURES_TARGET("avx512f") static unsigned eq(V a, V b) { return _mm512_cmpeq_epi32_mask(a, b); }
+	STRUCTURES_TARGET("avx512f") static V min(V a, V b) { return _mm512_mask_min_epi32(a, 0xFFFF, a, b); }
+	STRUCTURES_TARGET("avx512f") static V max(V a, V b) { return _mm512_mask_max_epi32(a, 0xFFFF, a, b); }
+};
+
+template <typename T_>
+struct Avx512i64 {
+	using T = T_;
+	using V = __m512i;
+	const static int lanes = 8;
+	STRUCTURES_TARGET("avx512f") static V load(const T* p) { return _mm512_loadu_si512(p); }
+	STRUCTURES_TARGET("avx512f") static V set1(T x) { return _mm512_set1_epi64(x); }
+	STRUCTURES_TARGET("avx512f") static unsigned eq(V a, V b) { return _mm512_cmpeq_epi64_mask(a, b); }
+	STRUCTURES_TARGET("avx512f") static V min(V a, V b) { return _mm512_mask_min_epi64(a, 0xFF, a, b); }
+	STRUCTURES_TARGET("avx512f") static V max(V a, V b) { return _mm512_mask_max_epi64(a, 0xFF, a, b); }
+};
+
+struct Avx512f32 {
+	using T = float;
+	using V = __m512;
+	const static int lanes = 16;
+	STRUCTURES_TARGET("avx512f") static V load(const T* p) { return _mm512_loadu_ps(p); }
+	STRUCTURES_TARGET("avx512f") static V set1(T x) { return _mm512_set1_ps(x); }
+	STRUCTURES_TARGET("avx512f") static unsigned eq(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+	STRUCTURES_TARGET("avx512f") static V min(V a, V b) { return _mm512_mask_min_ps(a, 0xFFFF, a, b); }
+	STRUCTURES_TARGET("avx512f") static V max(V a, V b) { return _mm512_mask_max_ps(a, 0xFFFF, a, b); }
+};
+
+struct Avx512f64 {
+	using T = double;
+	using V = __m512d;
+	const static int lanes = 8;
+	STRUCTURES_TARGET("avx512f") static V load(const T* p) { return _mm512_loadu_pd(p); }
+	STRUCTURES_TARGET("avx512f") static V set1(T x) { return _mm512_set1_pd(x); }
+	STRUCTURES_TARGET("avx512f") static unsigned eq(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+	STRUCTURES_TARGET("avx512f") static V min(V a, V b) { return _mm512_mask_min_pd(a, 0xFF, a, b); }
+	STRUCTURES_TARGET("avx512f") static V max(V a, V b) { return _mm512_mask_max_pd(a, 0xFF, a, b); }
+};
+
+/* The kernels, compiled once per instruction set. min and max first find the
+   extreme value with vector min/max and then its first position with find */
+#define STRUCTURES_SIMD_KERNELS(name_, isa_)                                       \
+	namespace name_ {                                                              \
+	template <typename L>                                                          \
+	__attribute__((target(isa_))) std::size_t find(const typename L::T* data,     \
+												   std::size_t n,                 \
+												   typename L::T x) {             \
+		auto vx = L::set1(x);                                                      \
+		std::size_t i = 0;                                                         \
+		for (; i + L::lanes <= n; i += L::lanes) {                                 \
+			unsigned m = L::eq(L::load(data + i), vx);                             \
+			if (m)                                                                 \
+				return i + __builtin_ctz(m);                                       \
+		}                                                                          \
+		for (; i < n; ++i) {                                                       \
+			if (data[i] == x)                                                      \
+				return i;                                                          \
+		}                                                                          \
+		return n;                                                                  \
+	}                                                                              \
+                                                                                   \
+	template <typename L>                                                          \
+	__attribute__((target(isa_))) std::size_t count(const typename L::T* data,    \
+													std::size_t n,                \
+													typename L::T x) {            \
+		auto vx = L::set1(x);                                                      \
+		std::size_t c = 0, i = 0;                                                  \
+		for (; i + L::lanes <= n; i += L::lanes)                                   \
+			c += __builtin_popcount(L::eq(L::load(data + i), vx));                 \
+		for (; i < n; ++i)                                                         \
+			c += data[i] == x ? 1 : 0;                                             \
+		return c;                                                                  \
+	}                                                                              \
+                                                                                   \
+	template <typename L, bool Max>                                                \
+	__attribute__((target(isa_))) std::size_t extreme(const typename L::T* data,  \
+													  std::size_t n) {            \
+		using T = typename L::T;                                                   \
+		if (n < static_cast<std::size_t>(L::lanes))                                \
+			return Max ? Scalar<T>::max(data, n) : Scalar<T>::min(data, n);        \
+		auto acc = L::load(data);                                                  \
+		std::size_t i = L::lanes;                                                  \
+		for (; i + L::lanes <= n; i += L::lanes)                                   \
+			acc = Max ? L::max(acc, L::load(data + i))                             \
+					  : L::min(acc, L::load(data + i));                            \
+		T lanes[L::lanes];                                                         \
+		std::memcpy(lanes, &acc, sizeof(acc));                                     \
+		T best = lanes[0];                                                         \
+		for (int k = 1; k < L::lanes; ++k) {                                       \
+			if (Max ? best < lanes[k] : lanes[k] < best)                           \
+				best = lanes[k];                                                   \
+		}                                                                          \
+		for (; i < n; ++i) {                                                       \
+			if (Max ? best < data[i] : data[i] < best)                             \
+				best = data[i];                                                    \
+		}                                                                          \
+		return find<L>(data, n, best);                                             \
+	}                                                                              \
+	}
+
+STRUCTURES_SIMD_KERNELS(sse2, "sse2")
+STRUCTURES_SIMD_KERNELS(avx2, "avx2")
+STRUCTURES_SIMD_KERNELS(avx512, "avx512f")
+
+#undef STRUCTURES_SIMD_KERNELS
+#undef STRUCTURES_TARGET
+
+/* Picks the lane operations of 'T' for the running CPU */
+template <typename Sse2, typename Avx2, typename Avx512>
+struct Dispatch {
+	using T = typename Sse2::T;
+
+	static std::size_t find(const T* data, std::size_t n, const T& x) {
+		switch (isa()) {
+		case Isa::avx512: return avx512::find<Avx512>(data, n, x);
+		case Isa::avx2: return avx2::find<Avx2>(data, n, x);
+		default: return sse2::find<Sse2>(data, n, x);
+		}
+	}
+
+	static std::size_t count(const T* data, std::size_t n, const T& x) {
+		switch (isa()) {
+		case Isa::avx512: return avx512::count<Avx512>(data, n, x);
+		case Isa::avx2: return avx2::count<Avx2>(data, n, x);
+		default: return sse2::count<Sse2>(data, n, x);
+		}
+	}
+
+	static std::size_t min(const T* data, std::size_t n) {
+		switch (isa()) {
+		case Isa::avx512: return avx512::extreme<Avx512, false>(data, n);
+		case Isa::avx2: return avx2::extreme<Avx2, false>(data, n);
+		default: return sse2::extreme<Sse2, false>(data, n);
+		}
+	}
+
+	static std::size_t max(const T* data, std::size_t n) {
+		switch (isa()) {
+		case Isa::avx512: return avx512::extreme<Avx512, true>(data, n);
+		case Isa::avx2: return avx2::extreme<Avx2, true>(data, n);
+		default: return sse2::extreme<Sse2, true>(data, n);
+		}
+	}
+};
+
+/* Kernels for 'T', chosen at compile time: vectorized for signed 32/64 bit
+   integers, float and double, plain loops otherwise */
+template <typename T, typename Enable = void>
+struct Kernels : Scalar<T> {};
+
+template <typename T>
+struct Kernels<T, typename std::enable_if<std::is_integral<T>::value &&
+										  std::is_signed<T>::value &&
+										  sizeof(T) == 4>::type>
+	: Dispatch<Sse2i32<T>, Avx2i32<T>, Avx512i32<T>> {};
+
+template <typename T>
+struct Kernels<T, typename std::enable_if<std::is_integral<T>::value &&
+										  std::is_signed<T>::value &&
+										  sizeof(T) == 8>::type>
+	: Dispatch<Sse2i64<T>, Avx2i64<T>, Avx512i64<T>> {};
+
+template <>
+struct Kernels<float> : Dispatch<Sse2f32, Avx2f32, Avx512f32> {};
+
+template <>
+struct Kernels<double> : Dispatch<Sse2f64, Avx2f64, Avx512f64> {};
+
+#else
+
+template <typename T>
+struct Kernels : Scalar<T> {};
+
+#endif
+
+/* Position of the first element equal to 'x', 'n' if there is none */
+template <typename T>
+std::size_t find(const T* data, std::size_t n, const T& x) {
+	return Kernels<T>::find(data, n, x);
+}
+
+/* Number of elements equal to 'x' */
+template <typename T>
+std::size_t count(const T* data, std::size_t n, const T& x) {
+	return Kernels<T>::count(data, n, x);
+}
+
+/* Position of the first smallest element, 'n' if there are none */
+template <typename T>
+std::size_t min_element(const T* data, std::size_t n) {
+	return Kernels<T>::min(data, n);
+}
+
+/* Position of the first largest element, 'n' if there are none */
+template <typename T>
+std::size_t max_element(const T* data, std::size_t n) {
+	return Kernels<T>::max(data, n);
+}
+
+}  // namespace simd
+
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <array_list.h>
+
+namespace structures {
+
+/* Skip list ordered set: the same surface as Tree (insert, remove, contains,
+ * in_order) in expected O(log n), plus lower_bound and forward iteration in
+ * ascending order.
+ * param T: data type of the elements */
+template <typename T>
+class SkipList {
+	struct Node;
+
+public:
+	/* Forward iterator over the elements in ascending order */
+	class const_iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const T*;
+		using reference = const T&;
+
+		const_iterator() = default;
+
+		const T& operator*() const { return node->x; }
+		const T* operator->() const { return &node->x; }
+
+		const_iterator& operator++() {
+			node = node->next[0];
+			return *this;
+		}
+
+		const_iterator operator++(int) {
+			const_iterator old{*this};
+			node = node->next[0];
+			return old;
+		}
+
+		bool operator==(const const_iterator& other) const {
+			return node == other.node;
+		}
+		bool operator!=(const const_iterator& other) const {
+			return node != other.node;
+		}
+
+	private:
+		friend class SkipList<T>;
+		explicit const_iterator(const Node* node_) : node{node_} {}
+
+		const Node* node{nullptr};
+	};
+
+	SkipList() : head{Node::create(T{}, max_level)} {}
+
+	SkipList(const SkipList<T>& other) : SkipList() {
+		Node* update[max_level];
+		for (int i = 0; i < max_level; ++i)
+			update[i] = head;
+		for (const Node* it = other.head->next[0]; it; it = it->next[0]) {
+			// Elements arrive in order, so every node is linked at the end
+			Node* n = Node::create(it->x, it->height);
+			for (int i = 0; i < n->height; ++i) {
+				update[i]->next[i] = n;
+				update[i] = n;
+			}
+			if (n->height > level_)
+				level_ = n->height;
+		}
+		size_ = other.size_;
+	}
+
+	SkipList(SkipList<T>&& other)
+		: head{other.head}, level_{other.level_}, size_{other.size_} {
+		other.head = Node::create(T{}, max_level);
+		other.level_ = 1;
+		other.size_ = 0;
+	}
+
+	SkipList<T>& operator=(const SkipList<T>& other) {
+		SkipList<T> copy{other};
+		swap(copy);
+		return *this;
+	}
+
+	SkipList<T>& operator=(SkipList<T>&& other) {
+		SkipList<T> copy{std::move(other)};
+		swap(copy);
+		return *this;
+	}
+
+	~SkipList() {
+		clear();
+		Node::destroy(head);
+	}
+
+	void clear() {
+		Node* it = head->next[0];
+		while (it) {
+			Node* next = it->next[0];
+			Node::destroy(it);
+			it = next;
+		}
+		for (int i = 0; i < max_level; ++i)
+			head->next[i] = nullptr;
+		level_ = 1;
+		size_ = 0;
+	}
+
+	/* Inserts 'x', returns false if it is already in the list */
+	bool insert(const T& x) {
+		Node* update[max_level];
+		Node* it = find_predecessors(x, update);
+		if (it && !(x < it->x))
+			return false;
+
+		int height = random_height();
+		if (height > level_) {
+			for (int i = level_; i < height; ++i)
+				update[i] = head;
+			level_ = height;
+		}
+		Node* n = Node::create(x, height);
+		for (int i = 0; i < height; ++i) {
+			n->next[i] = update[i]->next[i];
+			update[i]->next[i] = n;
+		}
+		++size_;
+		return true;
+	}
+
+	/* Removes 'x' from the list, if it exists else return false */
+	bool remove(const T& x) {
+		Node* update[max_level];
+		Node* it = find_predecessors(x, update);
+		if (!it || x < it->x)
+			return false;
+
+		for (int i = 0; i < it->height; ++i)
+			update[i]->next[i] = it->next[i];
+		Node::destroy(it);
+		while (level_ > 1 && !head->next[level_ - 1])
+			--level_;
+		--size_;
+		return true;
+	}
+
+	/* Returns true if the list contains 'x' */
+	bool contains(const T& x) const {
+		const Node* it = lower_node(x);
+		return it && !(x < it->x);
+	}
+
+	/* Returns an iterator to the first element not less than 'x' */
+	const_iterator lower_bound(const T& x) const {
+		return const_iterator{lower_node(x)};
+	}
+
+	const_iterator begin() const { return const_iterator{head->next[0]}; }
+
+	const_iterator end() const { return const_iterator{}; }
+
+	bool empty() const { return size_ == 0; }
+
+	/* Returns the size of the list */
+	std::size_t size() const { return size_; }
+
+	/* Returns a in-ordered list of the elements */
+	Arraylist<T> in_order() const {
+		Arraylist<T> out{size_ + 1};
+		for (const Node* it = head->next[0]; it; it = it->next[0])
+			out.push_at_back(it->x);
+		return out;
+	}
+
+private:
+	const static int max_level{32};
+
+	/* Node with 'height' forward pointers allocated in the same block */
+	struct Node {
+		static Node* create(const T& x, int height) {
+			void* p = ::operator new(sizeof(Node) + (height - 1) * sizeof(Node*));
+			Node* n = new (p) Node(x, height);
+			for (int i = 1; i < height; ++i)
+				n->next[i] = nullptr;
+			return n;
+		}
+
+		static void destroy(Node* n) {
+			n->~Node();
+			::operator delete(n);
+		}
+
+		T x;
+		int height;
+		Node* next[1];
+
+	private:
+		Node(const T& x_, int height_) : x{x_}, height{height_}, next{nullptr} {}
+	};
+
+	/* Fills 'update' with the last node before 'x' on every level and returns
+	   the first node not less than 'x' */
+	Node* find_predecessors(const T& x, Node** update) {
+		Node* it = head;
+		for (int i = level_ - 1; i >= 0; --i) {
+			while (it->next[i] && it->next[i]->x < x)
+				it = it->next[i];
+			update[i] = it;
+		}
+		return it->next[0];
+	}
+
+	const Node* lower_node(const T& x) const {
+		const Node* it = head;
+		for (int i = level_ - 1; i >= 0; --i) {
+			while (it->next[i] && it->next[i]->x < x)
+				it = it->next[i];
+		}
+		return it->next[0];
+	}
+
+	/* Geometric height with p = 1/4 */
+	int random_height() {
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		int height = 1;
+		for (std::uint64_t r = seed; (r & 3) == 0 && height < max_level; r >>= 2)
+			++height;
+		return height;
+	}
+
+	void swap(SkipList<T>& other) {
+		std::swap(head, other.head);
+		std::swap(level_, other.level_);
+		std::swap(size_, other.size_);
+	}
+
+	Node* head;
+	int level_{1};
+	std::size_t size_{0u};
+	std::uint64_t seed{0x9e3779b97f4a7c15ULL};
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+namespace structures {
+
+namespace soa {
+
+template <std::size_t... I>
+struct Indices {};
+
+template <std::size_t N, std::size_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+
+template <std::size_t... I>
+struct MakeIndices<0, I...> {
+	using type = Indices<I...>;
+};
+
+/* Contiguous view of one column: 'size' elements starting at 'data' */
+template <typename F>
+struct Column {
+	F* data;
+	std::size_t size;
+
+	F* begin() const { return data; }
+	F* end() const { return data + size; }
+	F& operator[](std::size_t i) const { return data[i]; }
+	bool empty() const { return size == 0; }
+};
+
+}  // namespace soa
+
+/* List of records stored as a structure of arrays: every field of the
+ * record lives in its own contiguous column, so a scan over one field reads
+ * only that field's memory (and can be vectorized through column<I>()).
+ * Rows are read and written through proxy references; a whole row is a
+ * std::tuple<Fields...>.
+ * param Fields: types of the fields of a record */
+template <typename... Fields>
+class SoAArraylist {
+	using Is = typename soa::MakeIndices<sizeof...(Fields)>::type;
+
+public:
+	using Row = std::tuple<Fields...>;
+
+	template <std::size_t I>
+	using Field = typename std::tuple_element<I, Row>::type;
+
+	/* Proxy for the row at one position: get<I>() reaches a single field,
+	   conversion reads and assignment writes the whole row */
+	template <typename List>
+	class Proxy {
+	public:
+		Proxy(List& list_, std::size_t index_) : list(list_), index(index_) {}
+
+		template <std::size_t I>
+		auto get() const -> decltype(std::declval<List&>().template column<I>()[0]) {
+			return list.template column<I>()[index];
+		}
+
+		operator Row() const { return list.row(index, Is{}); }
+
+		template <typename L = List,
+				  typename = typename std::enable_if<!std::is_const<L>::value>::type>
+		const Proxy& operator=(const Row& row) const {
+			list.set(index, row, Is{});
+			return *this;
+		}
+
+		const Proxy& operator=(const Proxy& other) const {
+			return *this = static_cast<Row>(other);
+		}
+
+	private:
+		List& list;
+		std::size_t index;
+	};
+
+	using Reference = Proxy<SoAArraylist<Fields...>>;
+	using ConstReference = Proxy<const SoAArraylist<Fields...>>;
+
+	SoAArraylist() : SoAArraylist(starting_size) {}
+
+	/* Construct given max_size = maximum # of rows before growing */
+	explicit SoAArraylist(std::size_t max_size)
+		: columns{std::unique_ptr<Fields[]>{new Fields[max_size > 0 ? max_size : 1]}...}
+		, max_size_{max_size > 0 ? max_size : 1} {}
+
+	SoAArraylist(const SoAArraylist<Fields...>& other) : SoAArraylist(other.max_size_) {
+		copy_columns(other, Is{});
+		size_ = other.size_;
+	}
+
+	SoAArraylist(SoAArraylist<Fields...>&& other)
+		: columns{std::move(other.columns)}
+		, size_{other.size_}
+		, max_size_{other.max_size_} {
+		other.size_ = 0;
+		other.max_size_ = 0;
+	}
+
+	SoAArraylist<Fields...>& operator=(const SoAArraylist<Fields...>& other) {
+		SoAArraylist<Fields...> copy{other};
+		swap(copy);
+		return *this;
+	}
+
+	SoAArraylist<Fields...>& operator=(SoAArraylist<Fields...>&& other) {
+		SoAArraylist<Fields...> copy{std::move(other)};
+		swap(copy);
+		return *this;
+	}
+
+	/* To clear all rows */
+	void clear() { size_ = 0; }
+
+	/* Add a row at the end of the list */
+	void push_at_back(const Fields&... fields) { insert(Row{fields...}, size_); }
+
+	void push_at_back(const Row& row) { insert(row, size_); }
+
+	/* Add a row at the beginning of the list */
+	void push_at_front(const Row& row) { insert(row, 0); }
+
+	/* Insert 'row' at a given position ('index') of the list */
+	void insert(const Row& row, std::size_t index) {
+		if (index > size_)
+			throw std::out_of_range("Index out of bounds");
+		if (size_ == max_size_)
+			reserve(max_size_ > 0 ? max_size_ * 2 : starting_size);
+		shift_up(index, Is{});
+		set(index, row, Is{});
+		size_++;
+	}
+
+	/* Remove the row at a given position ('index') and return it */
+	Row erase(std::size_t index) {
+		if (empty())
+			throw std::out_of_range("List is empty");
+		if (index >= size_)
+			throw std::out_of_range("Index out of bounds");
+		Row deleted = row(index, Is{});
+		shift_down(index, Is{});
+		size_--;
+		return deleted;
+	}
+
+	/* Remove the row at the end of the list */
+	Row pop_at_back() { return erase(size_ - 1); }
+
+	/* Remove the first row of the list */
+	Row pop_at_front() { return erase(0); }
+
+	/* Make room for 'n' rows without further allocation */
+	void reserve(std::size_t n) {
+		if (n > max_size_) {
+			grow(n, Is{});
+			max_size_ = n;
+		}
+	}
+
+	/* Return True if list is empty */
+	bool empty() const { return size_ == 0; }
+
+	/* Return the number of rows */
+	std::size_t size() const { return size_; }
+
+	/* Check that 'index' is valid and return the row at that position */
+	Reference at(std::size_t index) {
+		check(index);
+		return Reference{*this, index};
+	}
+
+	ConstReference at(std::size_t index) const {
+		check(index);
+		return ConstReference{*this, index};
+	}
+
+	Reference operator[](std::size_t index) { return Reference{*this, index}; }
+
+	ConstReference operator[](std::size_t index) const {
+		return ConstReference{*this, index};
+	}
+
+	Reference front() { return Reference{*this, 0}; }
+
+	ConstReference front() const { return ConstReference{*this, 0}; }
+
+	Reference back() { return Reference{*this, size_ - 1}; }
+
+	ConstReference back() const { return ConstReference{*this, size_ - 1}; }
+
+	/* Contiguous view of field 'I' of every row */
+	template <std::size_t I>
+	soa::Column<Field<I>> column() {
+		return {std::get<I>(columns).get(), size_};
+	}
+
+	template <std::size_t I>
+	soa::Column<const Field<I>> column() const {
+		return {std::get<I>(columns).get(), size_};
+	}
+
+	void swap(SoAArraylist<Fields...>& other) {
+		std::swap(columns, other.columns);
+		std::swap(size_, other.size_);
+		std::swap(max_size_, other.max_size_);
+	}
+
+private:
+	/* Runs each expression of a pack expansion in order */
+	static void expand(std::initializer_list<int>) {}
+
+	void check(std::size_t index) const {
+		if (index >= size_)
+			throw std::out_of_range("Index out of bounds");
+	}
+
+	template <std::size_t... I>
+	Row row(std::size_t index, soa::Indices<I...>) const {
+		return Row{std::get<I>(columns)[index]...};
+	}
+
+	template <std::size_t... I>
+	void set(std::size_t index, const Row& row, soa::Indices<I...>) {
+		expand({(std::get<I>(columns)[index] = std::get<I>(row), 0)...});
+	}
+
+	template <std::size_t... I>
+	void shift_up(std::size_t index, soa::Indices<I...>) {
+		expand({(shift_up(std::get<I>(columns).get(), index), 0)...});
+	}
+
+	template <typename F>
+	void shift_up(F* column, std::size_t index) {
+		for (std::size_t i = size_; i > index; --i)
+			column[i] = std::move(column[i - 1]);
+	}
+
+	template <std::size_t... I>
+	void shift_down(std::size_t index, soa::Indices<I...>) {
+		expand({(shift_down(std::get<I>(columns).get(), index), 0)...});
+	}
+
+	template <typename F>
+	void shift_down(F* column, std::size_t index) {
+		for (std::size_t i = index; i + 1 < size_; ++i)
+			column[i] = std::move(column[i + 1]);
+	}
+
+	template <std::size_t... I>
+	void grow(std::size_t n, soa::Indices<I...>) {
+		expand({(grow(std::get<I>(columns), n), 0)...});
+	}
+
+	template <typename F>
+	void grow(std::unique_ptr<F[]>& column, std::size_t n) {
+		std::unique_ptr<F[]> copy{new F[n]};
+		for (std::size_t i = 0; i < size_; ++i)
+			copy[i] = std::move(column[i]);
+		column = std::move(copy);
+	}
+
+	template <std::size_t... I>
+	void copy_columns(const SoAArraylist<Fields...>& other, soa::Indices<I...>) {
+		expand({(copy_column(std::get<I>(columns), std::get<I>(other.columns), other.size_), 0)...});
+	}
+
+	template <typename F>
+	static void copy_column(std::unique_ptr<F[]>& to, const std::unique_ptr<F[]>& from,
+							std::size_t n) {
+		for (std::size_t i = 0; i < n; ++i)
+			to[i] = from[i];
+	}
+
+	const static std::size_t starting_size{8};
+
+	std::tuple<std::unique_ptr<Fields[]>...> columns;
+	std::size_t size_{0u};
+	std::size_t max_size_;
+};
+
+template <typename... Fields>
+const std::size_t SoAArraylist<Fields...>::starting_size;
+
+}
\ No newline at end of file
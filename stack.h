@@ -1,17 +1,31 @@
 #include <cstdint>
+#include <utility>
 #include <array_list.h>
+#include <static_array_list.h>
 
 namespace structures {
 
 template <typename T, typename Container>
 class StackWrapper {
 public:
-	void push(const T& data) { return cont.push_at_back(data); }
+	/* Fixed capacity containers report overflow by returning false */
+	auto push(const T& data)
+		-> decltype(std::declval<Container&>().push_at_back(data)) {
+		return cont.push_at_back(data);
+	}
 	T pop() { return cont.pop_at_back(); }
+	/* Pops the top into 'data', returns false (and never throws) when empty */
+	bool try_pop(T& data) {
+		if (cont.empty())
+			return false;
+		data = cont.pop_at_back();
+		return true;
+	}
 	T& top() { return cont.back(); }
 	const T& top() const { return cont.back(); }
 	void clear() { return cont.clear(); }
 	std::size_t size() const { return cont.size(); }
+	bool empty() const { return cont.empty(); }
 
 private:
 	Container cont;
@@ -20,6 +34,10 @@ private:
 template <typename T>
 class Stack : public StackWrapper<T, Arraylist<T>> {};
 
+/* Fixed capacity stack that never allocates, push returns false when full */
+template <typename T, std::size_t N>
+class StaticStack : public StackWrapper<T, StaticArraylist<T, N>> {};
+
 }  
 
 /* name trait */
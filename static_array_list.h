@@ -0,0 +1,138 @@
+#include <cstdint>
+#include <stdexcept>
+
+namespace structures {
+/* Fixed capacity list stored inline (no heap allocation), capacity given by
+   the template parameter 'N'. Insertions return false instead of throwing or
+   growing when the list is full */
+
+template <typename T, std::size_t N>
+class StaticArraylist {
+public:
+	constexpr StaticArraylist() = default;
+
+	/* To clear all elements */
+	void clear() { size_ = 0; }
+
+	/* Add 'data' at the end of the list, false if the list is full */
+	bool push_at_back(const T& data) {
+		if (full())
+			return false;
+		contents[size_++] = data;
+		return true;
+	}
+
+	/* Add 'data' at the beginning of the list, false if the list is full */
+	bool push_at_front(const T& data) { return insert(data, 0); }
+
+	/* Insert an element ('data') at a given position ('index') of the list,
+	   false if the list is full */
+	bool insert(const T& data, std::size_t index) {
+		if (index > size_) {
+			throw std::out_of_range("Index out of bounds");
+		} else if (full()) {
+			return false;
+		} else {
+			for (std::size_t i = size_; i > index; i--) {
+				contents[i] = contents[i - 1];
+			}
+			contents[index] = data;
+			size_++;
+			return true;
+		}
+	}
+
+	/* Insert an element 'data' sorted to the list, false if the list is full */
+	bool insert_sorted(const T& data) {
+		std::size_t i = 0;
+		while (i < size_ && data >= contents[i])
+			i++;
+		return insert(data, i);
+	}
+
+	/* Remove an element from a given position ('index') */
+	T erase(std::size_t index) {
+		if (empty()) {
+			throw std::out_of_range("List is empty");
+		} else if (index >= size_) {
+			throw std::out_of_range("Index out of bounds");
+		} else {
+			T deleted = contents[index];
+			for (std::size_t i = index; i < size_ - 1; ++i) {
+				contents[i] = contents[i + 1];
+			}
+			size_--;
+			return deleted;
+		}
+	}
+
+	/* Remove the element at the end of the list*/
+	T pop_at_back() { return erase(size_ - 1); }
+
+	/* Remove first element of a list */
+	T pop_at_front() { return erase(0); }
+
+	/* Remove an element 'data' from the list */
+	void remove(const T& data) { erase(find(data)); }
+
+	/* Return True if list is empty */
+	constexpr bool empty() const { return size_ == 0; }
+
+	/* Return True if no more elements fit */
+	constexpr bool full() const { return size_ == N; }
+
+	/* return True if the list contains 'data' */
+	bool contains(const T& data) const { return find(data) != size_; }
+
+	/* Return the position of 'data' in the list */
+	std::size_t find(const T& data) const {
+		for (std::size_t i = 0; i < size_; ++i) {
+			if (contents[i] == data)
+				return i;
+		}
+		return size_;
+	}
+
+	/* Return the list's size */
+	constexpr std::size_t size() const { return size_; }
+
+	/* Return the maximum number of elements */
+	constexpr std::size_t capacity() const { return N; }
+
+	/* Check for the 'index' that it is valid in the
+	list and then return the reference to the element
+	at the given index position */
+	T& at(std::size_t index) {
+		return const_cast<T&>(
+			static_cast<const StaticArraylist*>(this)->at(index));
+	}
+
+	const T& at(std::size_t index) const {
+		if (index >= size_) {
+			throw std::out_of_range("Index out of bounds");
+		} else {
+			return contents[index];
+		}
+	}
+
+	/* Returns the reference to the element at 'index' position of the list*/
+	T& operator[](std::size_t index) { return contents[index]; }
+
+	constexpr const T& operator[](std::size_t index) const {
+		return contents[index];
+	}
+
+	T& front() { return contents[0]; }
+
+	constexpr const T& front() const { return contents[0]; }
+
+	T& back() { return contents[size_ - 1]; }
+
+	constexpr const T& back() const { return contents[size_ - 1]; }
+
+private:
+	T contents[N]{};
+	std::size_t size_{0u};
+};
+
+}
@@ -0,0 +1,204 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace structures {
+
+/* Work stealing thread pool.
+ * Every worker owns a deque of tasks: it runs its own newest task first and,
+ * when the deque is empty, steals the oldest task of another worker. Tasks
+ * submitted from outside the pool are spread round robin.
+ * Tasks are usually run through a Taskgroup, whose wait() executes pending
+ * tasks instead of blocking, so tasks may themselves fork and join. */
+class Threadpool {
+public:
+	/* Starts 'threads' workers (at least one) */
+	explicit Threadpool(std::size_t threads = std::thread::hardware_concurrency())
+		: count{threads > 0 ? threads : 1}, queues{new Queue[count]} {
+		for (std::size_t i = 0; i < count; ++i)
+			workers.emplace_back(new std::thread([this, i] { work(i); }));
+	}
+
+	Threadpool(const Threadpool&) = delete;
+	Threadpool& operator=(const Threadpool&) = delete;
+
+	~Threadpool() {
+		{
+			std::lock_guard<std::mutex> lock{sleep_mutex};
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto& w : workers)
+			w->join();
+	}
+
+	/* Pool shared by the parallel algorithms unless they are given another */
+	static Threadpool& global() {
+		static Threadpool pool;
+		return pool;
+	}
+
+	/* Returns the number of workers */
+	std::size_t size() const { return count; }
+
+	/* Queues 'task'. From a worker it goes to that worker's own deque */
+	void submit(std::function<void()> task) {
+		std::size_t i = current_index(this);
+		if (i == npos)
+			i = next.fetch_add(1) % count;
+		{
+			std::lock_guard<std::mutex> lock{queues[i].mutex};
+			queues[i].tasks.push_back(std::move(task));
+		}
+		pending.fetch_add(1);
+		{
+			std::lock_guard<std::mutex> lock{sleep_mutex};
+		}
+		wake.notify_one();
+	}
+
+	/* Runs one queued task on the calling thread, false if none was found */
+	bool run_one() {
+		std::function<void()> task;
+		std::size_t i = current_index(this);
+		if (!take(i == npos ? 0 : i, task))
+			return false;
+		task();
+		return true;
+	}
+
+private:
+	const static std::size_t npos{static_cast<std::size_t>(-1)};
+
+	struct Queue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	/* Index of the calling thread in 'pool', npos for other threads */
+	static std::size_t current_index(const Threadpool* pool,
+									 const Threadpool* set_pool = nullptr,
+									 std::size_t set_index = npos) {
+		static thread_local const Threadpool* owner{nullptr};
+		static thread_local std::size_t index{npos};
+		if (set_pool) {
+			owner = set_pool;
+			index = set_index;
+		}
+		return owner == pool ? index : npos;
+	}
+
+	/* Pops the newest task of queue 'own', or steals the oldest of another */
+	bool take(std::size_t own, std::function<void()>& task) {
+		for (std::size_t k = 0; k < count; ++k) {
+			std::size_t i = (own + k) % count;
+			std::lock_guard<std::mutex> lock{queues[i].mutex};
+			auto& tasks = queues[i].tasks;
+			if (tasks.empty())
+				continue;
+			if (k == 0) {
+				task = std::move(tasks.back());
+				tasks.pop_back();
+			} else {
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+			pending.fetch_sub(1);
+			return true;
+		}
+		return false;
+	}
+
+	void work(std::size_t i) {
+		current_index(this, this, i);
+		std::function<void()> task;
+		while (true) {
+			if (take(i, task)) {
+				task();
+				task = nullptr;
+				continue;
+			}
+			std::unique_lock<std::mutex> lock{sleep_mutex};
+			wake.wait(lock, [this] { return stopping || pending.load() > 0; });
+			if (stopping && pending.load() == 0)
+				return;
+		}
+	}
+
+	std::size_t count;
+	std::unique_ptr<Queue[]> queues;
+	std::deque<std::unique_ptr<std::thread>> workers;
+	std::atomic<std::size_t> pending{0};
+	std::atomic<std::size_t> next{0};
+	std::mutex sleep_mutex;
+	std::condition_variable wake;
+	bool stopping{false};
+};
+
+/* Set of tasks that can be waited for together. wait() runs queued tasks
+ * (of any group) while it waits, so waiting inside a task cannot deadlock.
+ * An exception thrown by a task is caught on the worker; once every task has
+ * finished, wait() rethrows the first one */
+class Taskgroup {
+public:
+	explicit Taskgroup(Threadpool& pool_) : pool(pool_) {}
+
+	Taskgroup(const Taskgroup&) = delete;
+	Taskgroup& operator=(const Taskgroup&) = delete;
+
+	~Taskgroup() { finish(); }
+
+	/* Queues 'f' on the pool as part of this group */
+	template <typename F>
+	void run(F f) {
+		left.fetch_add(1);
+		pool.submit([this, f] {
+			try {
+				f();
+			} catch (...) {
+				fail(std::current_exception());
+			}
+			left.fetch_sub(1);
+		});
+	}
+
+	/* Returns once every task of the group has finished, rethrowing the
+	   first exception a task threw */
+	void wait() {
+		finish();
+		std::exception_ptr e;
+		{
+			std::lock_guard<std::mutex> lock{error_mutex};
+			std::swap(e, error);
+		}
+		if (e)
+			std::rethrow_exception(e);
+	}
+
+private:
+	void finish() {
+		while (left.load() > 0) {
+			if (!pool.run_one())
+				std::this_thread::yield();
+		}
+	}
+
+	void fail(std::exception_ptr e) {
+		std::lock_guard<std::mutex> lock{error_mutex};
+		if (!error)
+			error = e;
+	}
+
+	Threadpool& pool;
+	std::atomic<std::size_t> left{0};
+	std::mutex error_mutex;
+	std::exception_ptr error;
+};
+
+}
\ No newline at end of file
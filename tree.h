@@ -56,6 +56,58 @@ public:
 		return root ? root->contains(x) : false;
 	}
 
+	/* Looks up keys[0..n) at once: out[i] points to the element equal to
+	   keys[i], or is nullptr. The walks of up to 'lanes' keys are interleaved,
+	   one step of each in turn, and every step prefetches the next node, so
+	   the cache misses of different keys overlap instead of stalling one
+	   after the other */
+	void find_many(const T* keys, std::size_t n, const T** out) const {
+		const static std::size_t lanes{16};
+		const static std::size_t idle{static_cast<std::size_t>(-1)};
+		const Node* cursor[lanes];
+		std::size_t key[lanes];
+		std::size_t next = 0, active = 0;
+		for (std::size_t l = 0; l < lanes; ++l) {
+			key[l] = next < n ? next++ : idle;
+			cursor[l] = root;
+			active += key[l] != idle;
+		}
+		while (active > 0) {
+			for (std::size_t l = 0; l < lanes; ++l) {
+				if (key[l] == idle)
+					continue;
+				const Node* node = cursor[l];
+				const T& x = keys[key[l]];
+				if (node && !(x == node->data)) {
+					cursor[l] = x < node->data ? node->left : node->right;
+					__builtin_prefetch(cursor[l]);
+					continue;
+				}
+				out[key[l]] = node ? &node->data : nullptr;
+				// The lane takes the next key, or retires
+				if (next < n) {
+					key[l] = next++;
+					cursor[l] = root;
+				} else {
+					key[l] = idle;
+					--active;
+				}
+			}
+		}
+	}
+
+	/* out[i] = contains(keys[i]) for keys[0..n), see find_many */
+	void contains_many(const T* keys, std::size_t n, bool* out) const {
+		const static std::size_t chunk{256};
+		const T* found[chunk];
+		for (std::size_t base = 0; base < n; base += chunk) {
+			std::size_t m = n - base < chunk ? n - base : chunk;
+			find_many(keys + base, m, found);
+			for (std::size_t i = 0; i < m; ++i)
+				out[base + i] = found[i] != nullptr;
+		}
+	}
+
 	void clear() {
 		while (size_ > 0)
 			remove(root->x);